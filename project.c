@@ -1,51 +1,163 @@
+#ifdef _WIN32
+    #define _CRT_RAND_S         /* rand_s: the OS generator behind RtlGenRandom */
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <time.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <limits.h>
 
 #ifdef _WIN32
-    #define CLEAR_CMD "cls"
+    #include <io.h>
+    #include <windows.h>
+    #ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+        #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+    #endif
+    #define syncFile(fd) _commit(fd)
 #else
-    #define CLEAR_CMD "clear"
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/resource.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define syncFile(fd) fsync(fd)
 #endif
+#define CLEAR_SEQUENCE "\033[H\033[2J\033[3J"
 
 #define MAX_NAME 50
 #define MAX_PASS 50
+#define MAX_PASSWORD_HASH 112   /* "$s256$CC$<32 hex salt>$<64 hex hash>" */
 #define MAX_ADDR 100
 #define MAX_PHONE 15
 #define MAX_CATEGORY 30
-#define MAX_ORDER_ITEMS 20
 
 /* =============================== DATA STRUCTURES =============================== */
 
-/* 1. SINGLY LINKED LIST - Menu Items by Category */
+/* 1. HASH-INDEXED CATALOG - Menu Items by Category
+ *    Hot fields (id, price, stock) sit in contiguous blocks; the cold text
+ *    (name, category) lives in a parallel array of the same block. */
+#define MENU_BLOCK_ITEMS 1024
+
 typedef struct FoodItem {
     int id;
-    char name[80];
-    char category[30];
     float price;
-    int stock;
-    struct FoodItem *next;
+    _Atomic int stock;  /* Reserved with compare-and-swap at checkout */
+    int slot;           /* Position in the catalog */
+    int category;       /* Index into menuCatalog.categories */
+    int nextInCategory; /* Slot of the next item in the same category, -1 = last */
 } FoodItem;
 
-/* 2. DOUBLY LINKED LIST - Order Items */
-typedef struct OrderItem {
+typedef struct FoodItemText {
+    char name[80];
+    char category[MAX_CATEGORY];
+} FoodItemText;
+
+typedef struct MenuBlock {
+    FoodItem items[MENU_BLOCK_ITEMS];
+    FoodItemText text[MENU_BLOCK_ITEMS];
+} MenuBlock;
+
+typedef struct MenuCategory {
+    char name[MAX_CATEGORY];
+    int firstSlot;
+    int lastSlot;
+    int itemCount;
+    int nextInBucket;   /* Chain for the category name hash */
+} MenuCategory;
+
+/* Open addressing hash index: int key -> int value */
+#define ID_INDEX_EMPTY INT_MIN
+
+typedef struct IdIndex {
+    int *keys;
+    int *values;
+    int capacity;       /* Always a power of two */
+    int count;
+} IdIndex;
+
+/* Slab pool: fixed-size nodes carved from blocks, O(1) alloc and free.
+ *    Free nodes are chained through the node's own link field, so a whole
+ *    list of nodes goes back to the pool in one splice. */
+#define SLAB_BLOCK_NODES 256
+
+typedef struct SlabPool {
+    const char *name;
+    size_t nodeSize;
+    size_t linkOffset;      /* Offset of the node's next pointer */
+    void *freeList;
+    void **blocks;          /* Every refill, released together on reset */
+    int blockCount;
+    int blockCapacity;
+    long long live;
+    long long peak;
+    pthread_mutex_t lock;
+} SlabPool;
+
+#define SLAB_POOL(type, link) \
+    { #type, sizeof(type), offsetof(type, link), NULL, NULL, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER }
+
+/* Posting list of a name trigram: catalog slots, ascending */
+typedef struct MenuPosting {
+    int *slots;
+    int count;
+    int capacity;
+} MenuPosting;
+
+#define MENU_SEARCH_MAX 50
+
+typedef struct MenuCatalog {
+    MenuBlock **blocks;
+    int blockCount;
+    int blockCapacity;
+    int count;
+    int nextId;
+    IdIndex idIndex;            /* Item id -> slot */
+    MenuCategory *categories;   /* In order of first appearance */
+    int categoryCount;
+    int categoryCapacity;
+    int *categoryBuckets;       /* Category name hash -> first category, -1 = empty */
+    int bucketCount;
+    int *nameOrder;             /* Slots sorted by case-folded name */
+    int nameOrderCount;         /* Slots covered; below count means re-sort before use */
+    IdIndex trigramIndex;       /* Case-folded name trigram -> posting */
+    MenuPosting *postings;
+    int postingCount;
+    int postingCapacity;
+} MenuCatalog;
+
+/* 2. LINE ARENA - Order Lines
+ *    Every order's lines sit back to back in one shared arena; the order
+ *    keeps only their offset and count, so it pays for the lines it has.
+ *    Blocks never move, and an order longer than a block gets a run of
+ *    directory entries over one allocation, so its lines stay contiguous.
+ *    Names come from the catalog, so a line is just id, quantity and price. */
+#define LINE_BLOCK_LINES 16384
+#define LINE_MAX_BLOCKS 65536   /* Fixed directory: readers never see it move */
+
+typedef struct OrderLine {
     int itemId;
-    char itemName[80];
     int quantity;
     float price;
-    struct OrderItem *prev;
-    struct OrderItem *next;
-} OrderItem;
+} OrderLine;
+
+typedef struct LineArena {
+    OrderLine *blocks[LINE_MAX_BLOCKS];
+    unsigned char owned[LINE_MAX_BLOCKS];  /* 1 = entry starts an allocation */
+    int blockCount;
+    unsigned int used;                  /* Next free line offset */
+    pthread_mutex_t lock;               /* Taken once per order, to reserve its run */
+} LineArena;
 
 /* 3. ORDER DETAILS with Status */
 typedef struct Order {
     int orderId;
-    char username[MAX_NAME];
-    char address[MAX_ADDR];
-    char phone[MAX_PHONE];
-    OrderItem *items;  /* Doubly linked list of items */
+    int customerId;    /* Interned username/address/phone, see customerTable */
+    unsigned int lineOffset; /* First line in lineArena */
     int itemCount;
     float subtotal;
     float discount;
@@ -56,156 +168,977 @@ typedef struct Order {
     int status;   /* 0=Pending, 1=Confirmed, 2=Preparing, 3=Out for Delivery, 4=Delivered, 5=Cancelled */
     time_t orderTime;
     time_t statusTime;
-    struct Order *next; /* For order stack */
+    int queueTicket;        /* Delivery queue ticket within its priority, -1 = not queued */
 } Order;
 
-/* 4. STACK - Order Processing */
+#define ORDER_STATUS_STRIPES 64 /* Status changes lock one stripe, by order id */
+
+/* 4. ORDER STORE - Single authoritative copy of every order
+ *    The stack, queue and history only hold handles (slots) into it. */
+#define ORDER_BLOCK_SIZE 1024
+#define ORDER_MAX_BLOCKS 65536  /* Fixed directory: readers never see it move */
+
+typedef int OrderHandle;    /* Slot in orderStore, -1 = none */
+
+typedef struct OrderStore {
+    Order *blocks[ORDER_MAX_BLOCKS];  /* Fixed-size blocks, so Order pointers never move */
+    int blockCount;
+    _Atomic int count;
+    IdIndex idIndex;        /* Order id -> slot, guarded by orderStoreLock */
+} OrderStore;
+
+/* CUSTOMER TABLE - Interned (username, address, phone) records
+ *    Every order from the same user at the same address shares one record;
+ *    an account interns the username alone. Fixed block directories keep
+ *    lookups by id lock-free while checkouts intern new records. */
+#define CUSTOMER_BLOCK_SIZE 1024
+#define CUSTOMER_MAX_BLOCKS 4096
+
+#define ORDER_HISTORY_PAGE 10
+
+typedef struct Account {
+    char username[MAX_NAME];
+    int nextInBucket;       /* Chain for equal username hashes, -1 = last */
+    int *orderIds;          /* This account's orders in placement order, newest last */
+    int orderCount;
+    int orderCapacity;
+} Account;
+
+typedef struct Customer {
+    int accountId;
+    int zone;               /* Delivery zone of the address street */
+    char address[MAX_ADDR];
+    char phone[MAX_PHONE];
+    int nextInBucket;       /* Chain for equal record hashes, -1 = last */
+} Customer;
+
+typedef struct CustomerTable {
+    Account *accountBlocks[CUSTOMER_MAX_BLOCKS];
+    Customer *customerBlocks[CUSTOMER_MAX_BLOCKS];
+    _Atomic int accountCount;
+    _Atomic int count;
+    IdIndex accountIndex;   /* Username hash -> first account in chain */
+    IdIndex customerIndex;  /* Record hash -> first customer in chain */
+    pthread_mutex_t lock;   /* Serialises interning */
+} CustomerTable;
+
+/* STACK - Order Processing */
 typedef struct OrderStack {
-    Order order;
-    struct OrderStack *next;
+    OrderHandle handle;
+    struct OrderStack *next;    /* Toward the bottom */
+    struct OrderStack *above;   /* Toward the top, so the oldest order can leave first */
 } OrderStack;
 
-/* 5. QUEUE - Delivery Queue */
+/* 5. BUCKETED PRIORITY QUEUE - Delivery Queue (one FIFO per priority)
+ *    Each node is also linked into a FIFO per (zone, priority), so a driver
+ *    batch collects same-zone orders without walking the whole queue. Both
+ *    lists of a priority are guarded by that priority's bucket lock. */
+#define PRIORITY_LEVELS 4
+#define DISPATCH_BATCH_MAX 16           /* Orders one driver can carry */
+#define DISPATCH_MAX_WAIT (30 * 60)     /* Seconds before an order is dispatched out of turn */
+
 typedef struct Delivery {
-    Order order;
+    OrderHandle handle;
+    int zone;
     struct Delivery *next;
+    struct Delivery *prev;
+    struct Delivery *zoneNext;
+    struct Delivery *zonePrev;
 } Delivery;
 
-/* 6. BST - User Management */
+typedef struct DeliveryBucket {
+    Delivery *front;
+    Delivery *rear;
+    int depth;
+    pthread_mutex_t lock;   /* One lock per priority level */
+    int tickets;            /* Tickets issued to orders joining this FIFO; restart when it empties */
+    int *departed;          /* Fenwick tree over tickets (1-based), 1 = that ticket has left */
+    int capacity;           /* Tickets the tree covers, a power of two */
+} DeliveryBucket;
+
+/* DELIVERY ZONES - One per street, interned as customer records are.
+ *    Fixed block directory, so zone pointers never move under the queue. */
+#define ZONE_BLOCK_SIZE 256
+#define ZONE_MAX_BLOCKS 1024
+
+typedef struct DeliveryZone {
+    char street[MAX_ADDR];
+    int nextInBucket;                   /* Chain for equal street hashes, -1 = last */
+    Delivery *front[PRIORITY_LEVELS];   /* Queued orders in this zone */
+    Delivery *rear[PRIORITY_LEVELS];
+} DeliveryZone;
+
+typedef struct ZoneTable {
+    DeliveryZone *blocks[ZONE_MAX_BLOCKS];
+    _Atomic int count;
+    IdIndex index;          /* Street hash -> first zone in chain */
+    pthread_mutex_t lock;   /* Serialises interning */
+} ZoneTable;
+
+/* ETA ENGINE - Rolling stage durations and dispatch rate
+ *    Status changes and dispatches fold into moving averages; an estimate
+ *    combines them with the order's queue ticket, so it never walks the queue. */
+#define ETA_STAGES 4                /* Pending -> Confirmed -> Preparing -> Out -> Delivered */
+#define ETA_SMOOTHING 0.2           /* Weight of the newest sample */
+#define ETA_MAX_SAMPLE (4 * 3600)   /* Longer gaps are idle time, not work */
+
+typedef struct EtaEngine {
+    double stageSeconds[ETA_STAGES];    /* Status s -> s + 1 */
+    double dispatchSeconds;             /* Between two orders leaving the queue */
+    time_t busySince;                   /* Last dispatch, or when the queue last filled; 0 = idle */
+    long long samples[ETA_STAGES + 1];  /* Stages, then dispatches */
+    pthread_mutex_t lock;
+} EtaEngine;
+
+/* KITCHEN PIPELINE - Pending -> Confirmed -> Preparing -> Out for Delivery -> Delivered
+ *    One worker pool per stage. Confirm workers take the oldest order off
+ *    the stack; later stages are fed through bounded lock-free MPMC rings
+ *    (sequence-numbered cells, one CAS per push or pop). A worker whose next
+ *    ring is full keeps its order and retries, so a saturated stage stalls
+ *    the stages before it and new orders wait on the stack. On real orders a
+ *    stage moves an order on after its handoff time or once it was moved on
+ *    by hand; an order not due yet goes to the back of the stage's ring. */
+#define PIPELINE_STAGES ETA_STAGES
+#define PIPELINE_MAX_WORKERS 16
+#define PIPELINE_RING_CAPACITY 64       /* Power of two */
+#define PIPELINE_IDLE_MICROS 200        /* Back-off when there is no input or no room */
+#define PIPELINE_BY_HAND -1             /* Handoff: only a status change by hand moves the order on */
+#define PIPELINE_WAIT_SECONDS 60        /* Default limit for pipeline wait */
+
+typedef struct PipelineCell {
+    _Atomic size_t sequence;    /* == position: free for that push; position + 1: holds data */
+    OrderHandle handle;
+    double readyAt;             /* When the order reached this stage */
+} PipelineCell;
+
+typedef struct PipelineRing {
+    PipelineCell *cells;
+    size_t mask;
+    _Alignas(64) _Atomic size_t enqueuePos;    /* Producers and consumers on separate lines */
+    _Alignas(64) _Atomic size_t dequeuePos;
+} PipelineRing;
+
+typedef struct PipelineStage {
+    const char *name;
+    int workers;
+    int handoffSeconds;                 /* Time in the stage before moving on, or PIPELINE_BY_HAND */
+    int workMicros;                     /* Simulated work per order, --bench-pipeline only */
+    pthread_t threads[PIPELINE_MAX_WORKERS];
+    PipelineRing input;                 /* Unused by the first stage, which reads the stack */
+    _Atomic int upstreamDone;           /* Set once nothing more can arrive */
+    _Atomic long long processed;
+    _Atomic long long latencyMicros;    /* Ready -> finished, summed */
+    _Atomic long long maxLatencyMicros;
+    _Atomic long long stalls;           /* Orders held back by a full next ring */
+    _Atomic long long stallMicros;
+} PipelineStage;
+
+typedef struct KitchenPipeline {
+    PipelineStage stages[PIPELINE_STAGES];
+    _Atomic int running;
+    _Atomic int active;                 /* Workers holding an order */
+    _Atomic long long moves;            /* Bumped after every ring push, so idle checks see handoffs */
+    double startedAt;
+    double stoppedAt;
+    pthread_mutex_t lock;               /* Serialises start and stop */
+} KitchenPipeline;
+
+/* 6. AVL TREE - User Management (iterative, never degenerates on sorted input) */
+#define USER_TREE_MAX_DEPTH 64  /* AVL height stays below 1.45 * log2(n) */
+
 typedef struct User {
     char username[MAX_NAME];
-    char password[MAX_PASS];
+    char credential[MAX_PASSWORD_HASH];    /* Salted hash; legacy plaintext until the next login */
     char address[MAX_ADDR];
     char phone[MAX_PHONE];
-    int loyaltyPoints;
+    _Atomic int loyaltyPoints;
+    int height;
     struct User *left;
     struct User *right;
 } User;
 
-/* 7. AVL Tree - Order History */
+/* CREDENTIALS - Salted, cost-tunable password hashes and verified-session tokens
+ *    Hashes are PBKDF2-HMAC-SHA256 with 2^cost iterations. A successful login
+ *    issues a random token; presenting it again is one hash-table probe. */
+#define PASSWORD_DEFAULT_COST 12
+#define PASSWORD_MIN_COST 4
+#define PASSWORD_MAX_COST 20
+#define PASSWORD_SALT_BYTES 16
+#define SESSION_TOKEN_BYTES 16
+#define SESSION_TOKEN_TTL (30 * 60)      /* Seconds */
+
+typedef struct Sha256 {
+    unsigned int state[8];
+    unsigned long long length;          /* Bytes hashed so far */
+    unsigned char block[64];
+    size_t used;
+} Sha256;
+
+typedef struct SessionToken {
+    unsigned char token[SESSION_TOKEN_BYTES];
+    struct User *user;
+    time_t expires;
+    struct SessionToken *next;
+} SessionToken;
+
+typedef struct TokenCache {
+    SessionToken **buckets;
+    int bucketCount;                    /* Power of two, 0 until the first login */
+    int count;
+    pthread_mutex_t lock;
+} TokenCache;
+
+/* 7. B+-STYLE LEAF BLOCKS - Order History
+ *    Orders arrive in id order, so history is a directory of full leaves
+ *    appended at the end. Each leaf keeps its ids in one cache line and a
+ *    running prefix of count/revenue sums; the directory keeps each leaf's
+ *    first key and the sums of every leaf before it. */
+#define HISTORY_LEAF_KEYS 16        /* 16 ids = one 64-byte cache line */
+
+typedef struct HistoryStats {
+    int count;
+    double revenue;         /* Sum of order totals */
+    double discounts;
+    double taxes;
+} HistoryStats;
+
+typedef struct HistoryLeaf {
+    int orderIds[HISTORY_LEAF_KEYS];
+    OrderHandle handles[HISTORY_LEAF_KEYS];
+    time_t orderTimes[HISTORY_LEAF_KEYS];   /* Non-decreasing with orderId (see createOrder), so also searchable */
+    HistoryStats prefix[HISTORY_LEAF_KEYS]; /* prefix[i] = entries 0..i of this leaf */
+    int count;
+    struct HistoryLeaf *next;               /* Leaf chain for scans, also the pool link */
+} HistoryLeaf;
+
 typedef struct OrderHistory {
-    Order order;
-    int height;
-    struct OrderHistory *left;
-    struct OrderHistory *right;
+    HistoryLeaf **leaves;
+    int *leafFirstId;       /* Separator keys, searched before touching a leaf */
+    time_t *leafFirstTime;
+    HistoryStats *leafBefore;   /* Sums of all leaves before leaf i */
+    int leafCount;
+    int leafCapacity;
+    int count;
 } OrderHistory;
 
-/* 8. SINGLY LINKED LIST - Promo Codes (Replaced Circular Linked List) */
+/* SALES ANALYTICS - Columnar counters fed by every checkout
+ *    Per-item and per-category columns are indexed by catalog slot and
+ *    category index; per-order columns hold one entry per sale so any
+ *    figure can be re-aggregated over the whole history with flat loops. */
+#define ANALYTICS_TOP_N 5
+
+typedef struct SalesAnalytics {
+    double *itemRevenue;        /* By catalog slot */
+    long long *itemUnits;
+    int itemCapacity;
+    double *categoryRevenue;    /* By menuCatalog category index */
+    int categoryCapacity;
+    float *orderTotal;          /* By sale, in checkout order */
+    float *orderDiscount;
+    int *orderUnits;            /* Basket size */
+    long long orderCount;
+    long long orderCapacity;
+    long long promoOrders;      /* Orders that got a discount */
+    pthread_mutex_t lock;
+} SalesAnalytics;
+
+typedef struct SalesSummary {
+    long long orders;
+    double revenue;
+    double discounts;
+    long long units;
+    long long promoOrders;
+} SalesSummary;
+
+/* ORDER JOURNAL - Append-only binary log of order events
+ *    Each record is a JournalHeader followed by `length` payload bytes. */
+#define JOURNAL_FILE "orders.journal"
+#define JOURNAL_TEMP_FILE "orders.journal.tmp"
+#define JOURNAL_MAGIC 0x32444F46u       /* "FOD2": items are OrderLine records */
+#define JOURNAL_MAGIC_V1 0x4A444F46u    /* "FODJ": items carried names, still readable */
+#define JOURNAL_SYNC_BATCH 32           /* Records per fsync */
+#define JOURNAL_COMPACT_MIN 4096        /* Never compact below this many records */
+
+enum JournalRecordType {
+    JOURNAL_CHECKPOINT = 1,             /* Next order id */
+    JOURNAL_ORDER,                      /* Full order with its items */
+    JOURNAL_STATUS,                     /* Status change */
+    JOURNAL_PUSH,                       /* Pushed on the order stack */
+    JOURNAL_POP,                        /* Popped from the order stack */
+    JOURNAL_ENQUEUE,                    /* Added to the delivery queue */
+    JOURNAL_DEQUEUE,                    /* Removed from the delivery queue */
+    JOURNAL_REDEMPTION                  /* Promo code redeemed at checkout */
+};
+
+typedef struct JournalHeader {
+    unsigned int magic;
+    unsigned int type;
+    unsigned int length;
+    unsigned int crc;                   /* CRC-32 of the payload */
+} JournalHeader;
+
+typedef struct JournalOrder {
+    int orderId;
+    char username[MAX_NAME];
+    char address[MAX_ADDR];
+    char phone[MAX_PHONE];
+    float subtotal;
+    float discount;
+    float deliveryFee;
+    float tax;
+    float total;
+    int priority;
+    int status;
+    long long orderTime;
+    long long statusTime;
+    int itemCount;                      /* JournalItem records follow */
+} JournalOrder;
+
+typedef OrderLine JournalItem;          /* Written straight from the line block */
+
+typedef struct JournalItemV1 {
+    int itemId;
+    int quantity;
+    float price;
+    char itemName[80];
+} JournalItemV1;
+
+typedef struct JournalEvent {
+    int orderId;
+    int status;
+    long long time;
+} JournalEvent;
+
+/* Absolute counts, so replaying over newer saved counters never lowers them */
+typedef struct JournalRedemption {
+    char code[20];
+    char username[MAX_NAME];            /* Empty = only the code-wide count */
+    int customerUses;                   /* -1 = not tracked per customer */
+    int totalUses;                      /* -1 = unchanged */
+} JournalRedemption;
+
+typedef struct OrderJournal {
+    FILE *file;
+    int records;                        /* Records currently in the file */
+    int redemptions;                    /* Promo records the last compaction kept */
+    int pending;                        /* Records written since the last fsync */
+    _Atomic int compactDue;             /* Set by journalAppend, acted on outside other locks */
+} OrderJournal;
+
+/* BINARY SNAPSHOT - Menu, users and promo codes in one mmap-able file
+ *    Fixed-size records reference strings by offset into a trailing table.
+ *    Every section starts on an 8-byte boundary, so records are read in place. */
+#define SNAPSHOT_FILE "data.snap"
+#define SNAPSHOT_TEMP_FILE "data.snap.tmp"
+#define SNAPSHOT_MAGIC 0x50414E53u      /* "SNAP" */
+#define SNAPSHOT_VERSION 3               /* 2: promo limits and redemptions, 3: aligned sections */
+#define SNAPSHOT_ALIGN 8                 /* Widest field in any record (promo validity times) */
+
+typedef struct SnapshotHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int menuCount;
+    unsigned int userCount;
+    unsigned int promoCount;
+    unsigned int menuOffset;            /* Byte offsets from the start of the file */
+    unsigned int userOffset;
+    unsigned int promoOffset;
+    unsigned int stringOffset;
+    unsigned int stringSize;
+    int nextMenuId;
+    unsigned int redemptionCount;
+    unsigned int redemptionOffset;
+} SnapshotHeader;
+
+typedef struct SnapshotMenuItem {
+    int id;
+    float price;
+    int stock;
+    unsigned int name;                  /* String table offsets */
+    unsigned int category;
+} SnapshotMenuItem;
+
+typedef struct SnapshotUser {
+    unsigned int username;
+    unsigned int credential;
+    unsigned int address;
+    unsigned int phone;
+    int loyaltyPoints;
+} SnapshotUser;
+
+typedef struct SnapshotPromo {
+    unsigned int code;
+    float discount;
+    long long validFrom;
+    long long validUntil;
+    int maxUses;
+    int maxUsesPerCustomer;
+    int uses;
+    int reserved;
+} SnapshotPromo;
+
+typedef struct SnapshotRedemption {
+    unsigned int promo;                 /* Index into the promo records */
+    unsigned int username;
+    int count;
+} SnapshotRedemption;
+
+typedef struct StringTable {
+    char *data;
+    unsigned int size;
+    unsigned int capacity;
+} StringTable;
+
+/* HEADLESS DRIVER - Scripted command stream */
+#define MAX_SCRIPT_LINE 512
+#define MAX_SCRIPT_ARGS 12
+
+/* MICROBENCHMARKS - Synthetic sweeps over the core data structures */
+#define BENCH_MIN_N 1000
+#define BENCH_DEFAULT_MAX_N 1000000
+#define BENCH_TIME_BUDGET 0.25          /* Seconds per lookup benchmark before it stops early */
+
+/* 8. HASHED PROMO TABLE - Promo Codes (Replaced Singly Linked List)
+ *    Codes sit in fixed blocks and are found through an open-addressing
+ *    table of slots. Usage limits are atomic counters, so concurrent
+ *    checkouts redeem without holding any table-wide lock. */
+#define PROMO_BLOCK_CODES 1024
+#define PROMO_MAX_BLOCKS 4096
+#define PROMO_REDEMPTION_STRIPES 64
+
 typedef struct PromoCode {
     char code[20];
-    float discount; /* percentage */
-    struct PromoCode *next;
+    float discount;             /* percentage */
+    time_t validFrom;           /* 0 = active immediately */
+    time_t validUntil;          /* 0 = never expires */
+    int maxUses;                /* Across all customers, 0 = unlimited */
+    int maxUsesPerCustomer;     /* 0 = unlimited */
+    _Atomic int uses;
 } PromoCode;
 
-/* 9. DOUBLY LINKED LIST - Shopping Cart */
+typedef struct PromoTable {
+    PromoCode *blocks[PROMO_MAX_BLOCKS];    /* Codes never move once added */
+    int blockCount;
+    int count;
+    int *slots;                 /* Code hash -> slot, -1 = empty */
+    int slotCapacity;           /* Power of two */
+    pthread_rwlock_t lock;      /* Shared for lookups, exclusive for inserts */
+} PromoTable;
+
+/* One customer's redemptions of one code, chained per stripe bucket */
+typedef struct PromoRedemption {
+    int promo;                  /* Slot in the promo table */
+    _Atomic int count;
+    char username[MAX_NAME];
+    struct PromoRedemption *next;
+} PromoRedemption;
+
+typedef struct RedemptionStripe {
+    PromoRedemption **buckets;
+    int bucketCount;            /* Power of two, 0 until the first redemption */
+    int count;
+    pthread_mutex_t lock;
+} RedemptionStripe;
+
+/* 9. DOUBLY LINKED LIST - Shopping Cart (one per session, pooled) */
+
 typedef struct CartItem {
     int itemId;
     char itemName[80];
     int quantity;
     float price;
     struct CartItem *prev;
-    struct CartItem *next;
+    struct CartItem *next;      /* Also links free items in the pool */
+    struct CartItem *nextInBucket;  /* Chain in the cart's item id index */
 } CartItem;
 
+#define CART_MIN_BUCKETS 16
+#define CART_POOLED_BUCKETS 64  /* Larger indexes are freed with the cart, so clearing stays cheap */
+
+typedef struct Cart {
+    CartItem *head;
+    CartItem *tail;
+    int lineCount;              /* Lets clearCart return the chain in one step */
+    int itemCount;              /* Sum of quantities, kept current on every change */
+    long long subtotalCents;    /* Exact running subtotal */
+    CartItem **buckets;         /* Item id -> line, one line per item id; kept while pooled */
+    int bucketCount;            /* Power of two, 0 until the first add */
+    struct Cart *nextFree;      /* Pool free list */
+} Cart;
+
+/* 10. SESSION - A logged-in shopper and their cart */
+typedef struct Session {
+    User *user;
+    Cart *cart;
+    char token[SESSION_TOKEN_BYTES * 2 + 1];    /* Revoked when the session closes, "" = none */
+} Session;
+
+/* PARALLEL CHECKOUT - Throughput benchmark workers */
+#define CHECKOUT_BENCH_ORDERS 200000    /* Checkouts per thread-count run */
+#define CHECKOUT_BENCH_ITEMS 1000
+
+typedef struct CheckoutWorker {
+    Session *session;
+    int orders;                         /* Checkouts to attempt */
+    int lines;                          /* Cart lines per checkout */
+    unsigned int seed;
+    int placed;
+    int rejected;                       /* Refused for lack of stock */
+    long long unitsOrdered;
+} CheckoutWorker;
+
+/* SCREEN BUFFER - One listing rendered in memory, written with a single call */
+typedef struct ScreenBuffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+} ScreenBuffer;
+
 /* =============================== GLOBAL VARIABLES =============================== */
-FoodItem *menuHead = NULL;           /* Singly Linked List */
-CartItem *cartHead = NULL;           /* Doubly Linked List - Shopping Cart */
-CartItem *cartTail = NULL;
-PromoCode *promoHead = NULL;         /* Singly Linked List */
+MenuCatalog menuCatalog = {0};       /* Hash-Indexed Catalog */
+SlabPool cartPool = SLAB_POOL(Cart, nextFree);          /* Pooled Carts - one per Session */
+SlabPool cartItemPool = SLAB_POOL(CartItem, next);
+SlabPool orderStackPool = SLAB_POOL(OrderStack, next);
+SlabPool deliveryPool = SLAB_POOL(Delivery, next);
+SlabPool historyPool = SLAB_POOL(HistoryLeaf, next);
+SlabPool redemptionPool = SLAB_POOL(PromoRedemption, next);
+SlabPool tokenPool = SLAB_POOL(SessionToken, next);
+SlabPool *slabPools[] = { &cartPool, &cartItemPool, &orderStackPool,
+                          &deliveryPool, &historyPool, &redemptionPool, &tokenPool };
+#define SLAB_POOL_COUNT ((int)(sizeof(slabPools) / sizeof(slabPools[0])))
+PromoTable promoTable = { .lock = PTHREAD_RWLOCK_INITIALIZER };  /* Hashed Promo Codes */
+RedemptionStripe redemptionStripes[PROMO_REDEMPTION_STRIPES];   /* Per-customer usage */
+OrderStore orderStore = {0};         /* Canonical Orders */
+LineArena lineArena = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Order Lines, back to back */
+CustomerTable customerTable = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Interned Customers */
 OrderStack *orderStackTop = NULL;    /* Stack */
-Delivery *deliveryFront = NULL;      /* Queue Front */
-Delivery *deliveryRear = NULL;       /* Queue Rear */
-User *userRoot = NULL;               /* BST Root */
-OrderHistory *historyRoot = NULL;    /* AVL Tree Root */
+OrderStack *orderStackBottom = NULL; /* Oldest pending order */
+DeliveryBucket deliveryBuckets[PRIORITY_LEVELS] = { /* Priority Queue, index = priority - 1 */
+    { NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, NULL, 0 }, { NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, NULL, 0 },
+    { NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, NULL, 0 }, { NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, NULL, 0 }
+};
+_Atomic int deliveryCount = 0;
+ZoneTable zoneTable = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Interned Delivery Zones */
+static const double etaSeedSeconds[ETA_STAGES + 1] = { 300, 1200, 300, 1500, 180 };  /* Until measured */
+EtaEngine etaEngine = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Seeded by resetEtaEngine() */
+KitchenPipeline kitchenPipeline = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Stage Worker Pools */
+static const char *pipelineStageNames[PIPELINE_STAGES] = { "Confirm", "Prepare", "Dispatch", "Deliver" };
+static const int pipelineDefaultMicros[PIPELINE_STAGES] = { 100, 800, 200, 600 };   /* Benchmark only */
+static const int pipelineDefaultHandoff[PIPELINE_STAGES] = { 0, PIPELINE_BY_HAND, PIPELINE_BY_HAND, PIPELINE_BY_HAND };
+User *userRoot = NULL;               /* AVL Tree Root */
+User *userNodeBlock = NULL;          /* Users bulk-allocated by loadSnapshot */
+int userNodeBlockCount = 0;
+OrderHistory history = {0};          /* B+-style Leaf Blocks */
+SalesAnalytics analytics = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Columnar Sales Counters */
+
+OrderJournal orderJournal = {0};
+
+_Atomic int currentOrderId = 1000;
+time_t lastOrderTime = 0;            /* Newest orderTime handed out or replayed */
+pthread_mutex_t orderClockLock = PTHREAD_MUTEX_INITIALIZER;  /* Pairs each new id with its timestamp */
 
-int currentOrderId = 1000;
+/* Locks for the structures checkout touches from worker threads.
+ * Order: checkoutGate, then stack/bucket, then journal; the menu catalog and user tree are
+ * only mutated from the UI thread. */
+pthread_rwlock_t orderStoreLock = PTHREAD_RWLOCK_INITIALIZER;
+pthread_rwlock_t checkoutGate = PTHREAD_RWLOCK_INITIALIZER;  /* Shared by checkouts, exclusive for compaction */
+pthread_mutex_t orderStackLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t historyLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t journalLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t orderStatusLocks[ORDER_STATUS_STRIPES];     /* By order id; admin and pipeline updates */
+
+_Atomic long long allocationCount = 0;      /* Every xmalloc/xcalloc/xrealloc call */
+
+int quietMode = 0;                   /* Headless: no screen clearing, prompts or chatter */
+int freshState = 0;                  /* --fresh: start from the defaults, load and persist nothing */
+FILE *recordFile = NULL;             /* Interactive session recording (--record) */
+ScreenBuffer screen = {0};           /* Pending screen output */
+TokenCache tokenCache = { .lock = PTHREAD_MUTEX_INITIALIZER };  /* Verified Sessions */
+int passwordCost = PASSWORD_DEFAULT_COST;                       /* New hashes; older ones upgrade at login */
 
 /* =============================== FUNCTION PROTOTYPES =============================== */
 /* Utility Functions */
+void* xmalloc(size_t size);
+void* xcalloc(size_t count, size_t size);
+void* xrealloc(void *ptr, size_t size);
+void notify(const char *format, ...);
+void recordCommand(const char *format, ...);
 void clearScreen();
+void screenPrintf(const char *format, ...);
+void screenFlush();
+const char* formatTimestamp(time_t when);
 void pressEnter();
 void printHeader(const char *title);
 void printLine();
 char* getStatusText(int status);
 char* getPriorityText(int priority);
 
-/* Singly Linked List - Menu */
+/* Slab Pools */
+void* slabAlloc(SlabPool *pool);
+void slabFree(SlabPool *pool, void *node);
+void slabFreeChain(SlabPool *pool, void *head, void *tail, long long count);
+void slabRelease(SlabPool *pool);
+void displayMemoryStats(FILE *out);
+
+/* Hash Index */
+unsigned int hashInt(int key);
+unsigned int hashString(const char *str);
+void idIndexInit(IdIndex *index, int capacity);
+void idIndexPut(IdIndex *index, int key, int value);
+int idIndexGet(const IdIndex *index, int key);
+void idIndexFree(IdIndex *index);
+
+/* Hash-Indexed Catalog - Menu */
+int findMenuCategory(const char *category);
+int addMenuCategory(const char *category);
+FoodItem* menuItemAt(int slot);
+const char* menuItemName(const FoodItem *item);
+const char* menuItemCategory(const FoodItem *item);
 FoodItem* createFoodItem(int id, const char *name, const char *category, float price, int stock);
 void addToMenu(const char *name, const char *category, float price, int stock);
 void displayAllMenu();
+void indexMenuItemName(int slot, const char *name);
+int searchMenuByPrefix(const char *prefix, int *slots, int max);
+int searchMenuBySubstring(const char *text, int *slots, int max);
+int searchMenuByCategory(const char *category, int *slots, int max);
+void displayMenuSearch(int mode, const char *query);
 FoodItem* findMenuItem(int id);
-void updateStock(int itemId, int quantity);
+int reserveStock(FoodItem *item, int quantity);
+void releaseStock(FoodItem *item, int quantity);
 
 /* Doubly Linked List - Shopping Cart */
-void addToCart(int itemId, int quantity);
-void displayCart();
-void removeFromCart(int itemId);
-void clearCart();
-float calculateCartTotal();
-
-/* Singly Linked List - Promo Codes (Replaced Circular Linked List) */
-void addPromoCode(const char *code, float discount);
-float applyPromoCode(const char *code, float total);
+Cart* createCart();
+void destroyCart(Cart *cart);
+void releaseCartPool();
+int addToCart(Cart *cart, int itemId, int quantity);
+void displayCart(Cart *cart);
+int removeFromCart(Cart *cart, int itemId);
+void clearCart(Cart *cart);
+float calculateCartTotal(Cart *cart);
+int cartItemCount(Cart *cart);
+CartItem* findCartLine(Cart *cart, int itemId);
+
+/* Session */
+Session* openSession(User *user);
+Session* resumeSession(const char *tokenHex, Session *current);
+void closeSession(Session *session);
+
+/* Hashed Promo Table - Promo Codes */
+PromoCode* promoAt(int slot);
+int findPromoSlot(const char *code);
+void reservePromoCapacity(int count);
+PromoCode* insertPromoCode(const char *code, float discount, time_t validFrom, time_t validUntil,
+                           int maxUses, int maxUsesPerCustomer);
+void addPromoCode(const char *code, float discount, int validDays, int maxUses, int maxUsesPerCustomer);
+int importPromoCodes(FILE *file);
+_Atomic int* redemptionCounter(int promo, const char *username);
+float redeemPromoCode(const char *code, const char *username, float total);
 void displayPromoCodes();
+void releasePromoCodes();
+
+/* Order Store */
+Order* orderAt(OrderHandle handle);
+OrderHandle findOrderHandle(int orderId);
+OrderHandle storeOrder(const Order *order);
+
+/* Customer Table */
+int findAccount(const char *username);
+int internCustomer(const char *username, const char *address, const char *phone);
+Customer* customerAt(int customerId);
+const char* accountName(int accountId);
+const char* orderUsername(const Order *order);
+void indexAccountOrder(int accountId, int orderId);
+int accountOrderCount(int accountId);
+int recentAccountOrders(int accountId, int skip, int k, int *out);
+int orderAccountId(const Order *order);
+void releaseCustomerTable();
 
 /* Order Management */
-Order* createOrder(const char *username, const char *address, const char *phone, int priority);
-OrderItem* createOrderItem(int itemId, const char *itemName, int quantity, float price);
-void addItemToOrder(Order *order, int itemId, const char *itemName, int quantity, float price);
+Order* createOrder(int customerId, int priority);
+OrderLine* orderLineAt(const Order *order, int index);
+OrderLine* allocOrderLines(Order *order, int count);
+void releaseOrderLines();
+int copyOrderLines(const Order *order, OrderLine *out);
 void displayOrderDetails(Order *order);
 void updateOrderStatus(Order *order, int newStatus);
+int advanceOrderStatus(Order *order, int expected, int newStatus);
 
 /* Stack - Order Processing */
-void pushOrder(Order order);
-Order popOrder();
+void stackPushHandle(OrderHandle handle, int journal);
+OrderHandle stackPopHandle(int journal);
+OrderHandle stackTakeOldest(time_t placedBefore, int journal);
+void stackRemoveHandle(OrderHandle handle);
+void pushOrder(OrderHandle handle);
+Order* popOrder();
 void displayOrderStack();
 
-/* Queue - Delivery System */
-void enqueueDelivery(Order order);
-Order dequeueDelivery();
+/* Bucketed Priority Queue - Delivery System */
+int priorityBucket(int priority);
+void deliveryAppend(OrderHandle handle, int journal);
+OrderHandle deliveryPopFront(int journal);
+int deliveryRemove(OrderHandle handle, int journal);
+int deliveryTakeBatch(int maxOrders, int maxWaitSeconds, time_t now, OrderHandle *out, int journal);
+void enqueueDelivery(OrderHandle handle);
+Order* dequeueDelivery();
+int dispatchBatch(int maxOrders, int maxWaitSeconds, OrderHandle *out);
+void displayDispatchBatch(const OrderHandle *handles, int count);
+void deliveryStreet(const char *address, char *street, size_t size);
+int internDeliveryZone(const char *address);
+const char* deliveryZoneName(int zone);
+void releaseDeliveryZones();
+int deliveryQueueDepth(int priority);
+int deliveryQueueSize();
 void displayDeliveryQueue();
 
-/* BST - User Management */
-User* createUser(const char *username, const char *password, const char *address, const char *phone);
+/* ETA Engine */
+void etaRecordStatus(int oldStatus, time_t oldStatusTime, int newStatus, time_t now);
+void etaRecordEnqueue(time_t now);
+void etaRecordDispatch(int count, time_t now);
+int deliveryOrdersAhead(const Order *order);
+time_t estimateDelivery(const Order *order, int *ahead);
+void resetEtaEngine();
+
+/* Kitchen Pipeline */
+void pauseMicros(int micros);
+int pipelineRingPush(PipelineRing *ring, OrderHandle handle, double readyAt);
+int pipelineRingPop(PipelineRing *ring, OrderHandle *handle, double *readyAt);
+int startKitchenPipeline(const int workers[], const int handoffSeconds[], const int workMicros[]);
+void stopKitchenPipeline();
+long long pipelineCompleted();
+int pipelineIdle();
+void displayPipelineStats();
+
+/* Credentials */
+void sha256Init(Sha256 *ctx);
+void sha256Update(Sha256 *ctx, const void *data, size_t length);
+void sha256Final(Sha256 *ctx, unsigned char digest[32]);
+void randomBytes(unsigned char *out, size_t length);
+int constantTimeEquals(const void *a, const void *b, size_t length);
+void derivePasswordKey(const char *password, const unsigned char *salt, int cost, unsigned char key[32]);
+void hashPassword(const char *password, int cost, char *credential);
+int verifyPassword(User *user, const char *password);
+void issueSessionToken(User *user, char *tokenHex);
+User* authenticateToken(const char *tokenHex);
+void revokeSessionToken(const char *tokenHex);
+void releaseSessionTokens();
+
+/* AVL Tree - User Management */
+User* createUser(const char *username, const char *credential, const char *address, const char *phone);
+int userHeight(User *node);
+User* rightRotateUser(User *y);
+User* leftRotateUser(User *x);
 User* insertUser(User *root, User *newUser);
 User* searchUser(User *root, const char *username);
+int isAdminUser(const User *user);
 void displayUsersInorder(User *root);
 void addLoyaltyPoints(const char *username, float purchaseAmount);
 void saveUsersInorder(User *root, FILE *file);
 
-/* AVL Tree - Order History */
-int height(OrderHistory *node);
+/* Order History */
 int maxInt(int a, int b);
-OrderHistory* rightRotateAVL(OrderHistory *y);
-OrderHistory* leftRotateAVL(OrderHistory *x);
-int getBalanceAVL(OrderHistory *node);
-OrderHistory* createOrderHistory(Order order);
-OrderHistory* insertOrderHistory(OrderHistory *node, Order order);
-void displayOrderHistoryInorder(OrderHistory *root);
-OrderHistory* searchOrderHistoryById(OrderHistory *root, int orderId);
-void displayUserOrderHistory(OrderHistory *root, const char *username);
+void appendOrderHistory(OrderHandle handle);
+void buildOrderHistory(const OrderHandle *handles, int count);
+void rebuildOrderHistory();
+void releaseOrderHistory();
+void displayOrderHistory();
+Order* searchOrderHistoryById(int orderId);
+HistoryStats historyRangeById(int firstId, int lastId);
+HistoryStats historyRangeByTime(time_t from, time_t to);
+int historyRank(int orderId);
+OrderHandle historySelect(int k);
+int historyPage(int afterOrderId, int k, int *orderIds);
+void displayHistoryStats(const char *label, HistoryStats stats);
+int displayUserOrderHistory(int accountId, int page);
 Order* searchOrderById(int orderId);
 void displayOrderStatus(int orderId, const char *username, int isAdmin);
 
+/* Sales Analytics */
+void recordSale(const Order *order);
+void rebuildSalesAnalytics();
+void releaseSalesAnalytics();
+SalesSummary summarizeSales(long long first, long long last);
+int topSellingItems(int n, int *slots, long long *units, double *revenue);
+void displaySalesAnalytics();
+
+/* Order Journal */
+unsigned int crc32(const void *data, size_t length);
+void journalAppend(int type, const void *payload, unsigned int length);
+void journalOrder(OrderHandle handle);
+void journalEvent(int type, const Order *order);
+void journalRedemption(const char *code, const char *username, int customerUses, int totalUses);
+void journalSync();
+void replayOrderJournal();
+void compactOrderJournal();
+void compactOrderJournalIfDue();
+void openOrderJournal();
+void closeOrderJournal();
+
+/* Binary Snapshot */
+unsigned int stringTableAdd(StringTable *table, const char *str);
+int saveSnapshot();
+int loadSnapshot();
+
 /* File Handling */
+void exportTextData();
+void importTextData();
 void saveData();
 void loadData();
 
 /* Core Functions */
 void initializeSystem();
-void checkout(const char *username, const char *address, const char *phone);
-void userDashboard(const char *username);
+void resetSystemState();
+Order* placeOrder(Session *session, const char *promoCode, int priority);
+void checkout(Session *session);
+int userDashboard(Session *session);
 void adminDashboard();
 void userLogin();
 void userSignup();
 void adminLogin();
 
+/* Microbenchmarks */
+double benchNow();
+long peakRssKb();
+unsigned int benchRandom();
+void benchReport(FILE *json, const char *op, int n, long long ops, double seconds, long long allocations);
+void reportOrderFootprint(int n, FILE *json);
+void benchmarkSize(int n, FILE *json);
+void runBenchmarks(int maxN, FILE *json);
+void* checkoutWorker(void *arg);
+void runCheckoutThroughput(int maxThreads, FILE *json);
+void runLoginBenchmark(FILE *json);
+void runDispatchSimulation(FILE *json);
+void runPipelineBenchmark(FILE *json);
+
+/* Headless Command Driver */
+int splitScriptLine(char *line, char *args[], int maxArgs);
+int runScriptCommand(char *args[], int argc, Session **session, FILE *out);
+void runScript(FILE *in, FILE *out);
+
 /* =============================== UTILITY FUNCTIONS =============================== */
+void* xmalloc(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL && size > 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    allocationCount++;
+    return ptr;
+}
+
+void* xcalloc(size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (ptr == NULL && count > 0 && size > 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    allocationCount++;
+    return ptr;
+}
+
+void* xrealloc(void *ptr, size_t size) {
+    void *resized = realloc(ptr, size);
+    if (resized == NULL && size > 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    allocationCount++;
+    return resized;
+}
+
+void notify(const char *format, ...) {
+    if (quietMode) return;
+    
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+void recordCommand(const char *format, ...) {
+    if (recordFile == NULL) return;
+    
+    va_list args;
+    va_start(args, format);
+    vfprintf(recordFile, format, args);
+    va_end(args);
+    fputc('\n', recordFile);
+    fflush(recordFile);
+}
+
 void clearScreen() {
-    system(CLEAR_CMD);
+    if (quietMode) return;
+#ifdef _WIN32
+    static int consoleReady = 0;
+    if (!consoleReady) {    /* The console only interprets the sequence once asked to */
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode;
+        if (GetConsoleMode(console, &mode)) {
+            SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+        consoleReady = 1;
+    }
+#endif
+    fputs(CLEAR_SEQUENCE, stdout);    /* Goes out with the next line, no shell */
+}
+
+void screenPrintf(const char *format, ...) {
+    va_list args;
+    for (;;) {
+        size_t room = screen.capacity - screen.length;
+        va_start(args, format);
+        int needed = vsnprintf(screen.data + screen.length, room, format, args);
+        va_end(args);
+        if (needed < 0) return;
+        if ((size_t)needed < room) {
+            screen.length += needed;
+            return;
+        }
+        
+        size_t capacity = screen.capacity ? screen.capacity * 2 : 16384;
+        while (capacity - screen.length <= (size_t)needed) capacity *= 2;
+        screen.data = (char*)xrealloc(screen.data, capacity);
+        screen.capacity = capacity;
+    }
+}
+
+/* Earlier stdio output goes first, then the whole buffered screen in one write */
+void screenFlush() {
+    if (screen.length == 0) return;
+    fflush(stdout);
+#ifdef _WIN32
+    fwrite(screen.data, 1, screen.length, stdout);
+    fflush(stdout);
+#else
+    size_t written = 0;
+    while (written < screen.length) {
+        ssize_t n = write(STDOUT_FILENO, screen.data + written, screen.length - written);
+        if (n <= 0) break;
+        written += (size_t)n;
+    }
+#endif
+    screen.length = 0;
+}
+
+/* ctime() text, formatted once per minute; seconds are patched in place */
+const char* formatTimestamp(time_t when) {
+    static char text[32];
+    static time_t minuteStart = -1;
+    
+    time_t minute = when - ((when % 60) + 60) % 60;
+    if (minute != minuteStart) {
+        const char *formatted = ctime(&minute);
+        if (formatted == NULL) return "?\n";
+        strncpy(text, formatted, sizeof(text) - 1);
+        minuteStart = minute;
+    }
+    int seconds = (int)(when - minute);
+    text[17] = (char)('0' + seconds / 10);    /* "Www Mmm dd hh:mm:SS yyyy\n" */
+    text[18] = (char)('0' + seconds % 10);
+    return text;
 }
 
 void pressEnter() {
+    if (quietMode) return;
     printf("\nPress Enter to continue...");
     while(getchar() != '\n');
     getchar();
@@ -243,758 +1176,4101 @@ char* getPriorityText(int priority) {
     }
 }
 
-/* =============================== SINGLY LINKED LIST - MENU =============================== */
-FoodItem* createFoodItem(int id, const char *name, const char *category, float price, int stock) {
-    FoodItem *newItem = (FoodItem*)malloc(sizeof(FoodItem));
-    newItem->id = id;
-    strcpy(newItem->name, name);
-    strcpy(newItem->category, category);
-    newItem->price = price;
-    newItem->stock = stock;
-    newItem->next = NULL;
-    return newItem;
-}
+/* =============================== SLAB POOLS =============================== */
+#define SLAB_LINK(pool, node) (*(void**)((char*)(node) + (pool)->linkOffset))
 
-void addToMenu(const char *name, const char *category, float price, int stock) {
-    static int nextId = 1;
-    FoodItem *newItem = createFoodItem(nextId++, name, category, price, stock);
-    
-    if (menuHead == NULL) {
-        menuHead = newItem;
-    } else {
-        FoodItem *current = menuHead;
-        while (current->next != NULL) {
-            current = current->next;
+void* slabAlloc(SlabPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    if (pool->freeList == NULL) {
+        if (pool->blockCount == pool->blockCapacity) {
+            pool->blockCapacity = pool->blockCapacity ? pool->blockCapacity * 2 : 16;
+            pool->blocks = (void**)xrealloc(pool->blocks, sizeof(void*) * pool->blockCapacity);
+        }
+        char *block = (char*)xcalloc(SLAB_BLOCK_NODES, pool->nodeSize);  /* Fresh nodes start zeroed */
+        pool->blocks[pool->blockCount++] = block;
+        
+        /* Thread the new nodes onto the free list, first node on top */
+        for (int i = SLAB_BLOCK_NODES - 1; i >= 0; i--) {
+            void *node = block + (size_t)i * pool->nodeSize;
+            SLAB_LINK(pool, node) = pool->freeList;
+            pool->freeList = node;
         }
-        current->next = newItem;
     }
-    printf("✓ Added: %s ($%.2f) to %s category\n", name, price, category);
-}
-
-void displayAllMenu() {
-    printHeader("MENU - ALL ITEMS");
     
-    FoodItem *current = menuHead;
-    char currentCategory[30] = "";
-    int firstCategory = 1;
-    
-    while (current != NULL) {
-        if (strcmp(currentCategory, current->category) != 0) {
-            if (!firstCategory) {
-                printf("\n");
-            }
-            strcpy(currentCategory, current->category);
-            printf("\n【 %s 】\n", currentCategory);
-            printf("ID\tName\t\t\tPrice\tStock\n");
-            printf("────────────────────────────────────────────────\n");
-            firstCategory = 0;
-        }
-        printf("%d\t%-20s\t$%.2f\t%d\n", 
-               current->id, current->name, current->price, current->stock);
-        current = current->next;
+    void *node = pool->freeList;
+    pool->freeList = SLAB_LINK(pool, node);
+    if (++pool->live > pool->peak) {
+        pool->peak = pool->live;
     }
+    pthread_mutex_unlock(&pool->lock);
+    return node;
 }
 
-FoodItem* findMenuItem(int id) {
-    FoodItem *current = menuHead;
-    while (current != NULL) {
-        if (current->id == id) return current;
-        current = current->next;
-    }
-    return NULL;
+void slabFree(SlabPool *pool, void *node) {
+    pthread_mutex_lock(&pool->lock);
+    SLAB_LINK(pool, node) = pool->freeList;
+    pool->freeList = node;
+    pool->live--;
+    pthread_mutex_unlock(&pool->lock);
 }
 
-void updateStock(int itemId, int quantity) {
-    FoodItem *item = findMenuItem(itemId);
-    if (item != NULL) {
-        item->stock -= quantity;
-        if (item->stock < 0) item->stock = 0;
-    }
+/* Returns `count` nodes already linked head..tail through the link field */
+void slabFreeChain(SlabPool *pool, void *head, void *tail, long long count) {
+    if (head == NULL) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    SLAB_LINK(pool, tail) = pool->freeList;
+    pool->freeList = head;
+    pool->live -= count;
+    pthread_mutex_unlock(&pool->lock);
 }
 
-/* =============================== DOUBLY LINKED LIST - SHOPPING CART =============================== */
-void addToCart(int itemId, int quantity) {
-    FoodItem *item = findMenuItem(itemId);
-    if (item == NULL) {
-        printf("Item not found!\n");
-        return;
+/* Frees every block at once; all nodes from this pool become invalid */
+void slabRelease(SlabPool *pool) {
+    for (int i = 0; i < pool->blockCount; i++) {
+        free(pool->blocks[i]);
     }
+    free(pool->blocks);
+    pool->blocks = NULL;
+    pool->freeList = NULL;
+    pool->blockCount = pool->blockCapacity = 0;
+    pool->live = pool->peak = 0;
+}
+
+void displayMemoryStats(FILE *out) {
+    fprintf(out, "%-14s %10s %10s %8s %12s\n", "Pool", "Live", "Peak", "Blocks", "Bytes");
     
-    if (item->stock < quantity) {
-        printf("Insufficient stock! Only %d available.\n", item->stock);
-        return;
-    }
-    
-    CartItem *newItem = (CartItem*)malloc(sizeof(CartItem));
-    newItem->itemId = itemId;
-    strcpy(newItem->itemName, item->name);
-    newItem->quantity = quantity;
-    newItem->price = item->price;
-    newItem->prev = NULL;
-    newItem->next = NULL;
-    
-    if (cartHead == NULL) {
-        cartHead = cartTail = newItem;
-    } else {
-        cartTail->next = newItem;
-        newItem->prev = cartTail;
-        cartTail = newItem;
+    long long totalBytes = 0;
+    for (int i = 0; i < SLAB_POOL_COUNT; i++) {
+        SlabPool *pool = slabPools[i];
+        long long bytes = (long long)pool->blockCount * SLAB_BLOCK_NODES * pool->nodeSize;
+        totalBytes += bytes;
+        fprintf(out, "%-14s %10lld %10lld %8d %12lld\n",
+                pool->name, pool->live, pool->peak, pool->blockCount, bytes);
     }
-    
-    printf("✓ Added %d x %s to cart\n", quantity, item->name);
+    fprintf(out, "%-14s %10s %10s %8s %12lld\n", "Total", "", "", "", totalBytes);
+    fprintf(out, "Heap allocations so far: %lld\n", (long long)allocationCount);
 }
 
-void displayCart() {
-    if (cartHead == NULL) {
-        printf("Your cart is empty!\n");
-        return;
+/* =============================== HASH INDEX =============================== */
+unsigned int hashInt(int key) {
+    return (unsigned int)key * 2654435761u;
+}
+
+unsigned int hashString(const char *str) {
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
     }
-    
-    printHeader("SHOPPING CART");
-    printf("Item\t\t\tQuantity\tPrice\tSubtotal\n");
-    printf("────────────────────────────────────────────────────────────\n");
-    
-    CartItem *current = cartHead;
-    float total = 0;
-    int itemCount = 0;
-    
-    while (current != NULL) {
-        float subtotal = current->price * current->quantity;
-        printf("%-20s\t%d\t\t$%.2f\t$%.2f\n", 
-               current->itemName, current->quantity, current->price, subtotal);
-        total += subtotal;
-        itemCount += current->quantity;
-        current = current->next;
+    return hash;
+}
+
+void idIndexInit(IdIndex *index, int capacity) {
+    index->capacity = capacity;
+    index->count = 0;
+    index->keys = (int*)xmalloc(sizeof(int) * capacity);
+    index->values = (int*)xmalloc(sizeof(int) * capacity);
+    for (int i = 0; i < capacity; i++) {
+        index->keys[i] = ID_INDEX_EMPTY;
     }
-    
-    printf("────────────────────────────────────────────────────────────\n");
-    printf("Total Items: %d\t\t\t\tTotal: $%.2f\n", itemCount, total);
 }
 
-void removeFromCart(int itemId) {
-    CartItem *current = cartHead;
-    
-    while (current != NULL) {
-        if (current->itemId == itemId) {
-            if (current->prev != NULL) {
-                current->prev->next = current->next;
-            } else {
-                cartHead = current->next;
-            }
-            
-            if (current->next != NULL) {
-                current->next->prev = current->prev;
-            } else {
-                cartTail = current->prev;
-            }
-            
-            printf("Removed %s from cart\n", current->itemName);
-            free(current);
-            return;
+static void idIndexGrow(IdIndex *index) {
+    IdIndex bigger;
+    idIndexInit(&bigger, index->capacity * 2);
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->keys[i] != ID_INDEX_EMPTY) {
+            idIndexPut(&bigger, index->keys[i], index->values[i]);
         }
-        current = current->next;
     }
-    
-    printf("Item not found in cart!\n");
+    idIndexFree(index);
+    *index = bigger;
 }
 
-void clearCart() {
-    CartItem *current = cartHead;
-    CartItem *next;
-    
-    while (current != NULL) {
-        next = current->next;
-        free(current);
-        current = next;
+void idIndexPut(IdIndex *index, int key, int value) {
+    if (index->keys == NULL) {
+        idIndexInit(index, 64);
+    } else if ((index->count + 1) * 4 > index->capacity * 3) {
+        idIndexGrow(index);   /* Keep load factor under 75% */
     }
     
-    cartHead = cartTail = NULL;
-    printf("Cart cleared!\n");
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int pos = hashInt(key) & mask;
+    while (index->keys[pos] != ID_INDEX_EMPTY && index->keys[pos] != key) {
+        pos = (pos + 1) & mask;
+    }
+    if (index->keys[pos] == ID_INDEX_EMPTY) {
+        index->keys[pos] = key;
+        index->count++;
+    }
+    index->values[pos] = value;
 }
 
-float calculateCartTotal() {
-    CartItem *current = cartHead;
-    float total = 0;
+int idIndexGet(const IdIndex *index, int key) {
+    if (index->keys == NULL) return -1;
     
-    while (current != NULL) {
-        total += current->price * current->quantity;
-        current = current->next;
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int pos = hashInt(key) & mask;
+    while (index->keys[pos] != ID_INDEX_EMPTY) {
+        if (index->keys[pos] == key) return index->values[pos];
+        pos = (pos + 1) & mask;
     }
-    
-    return total;
+    return -1;
+}
+
+void idIndexFree(IdIndex *index) {
+    free(index->keys);
+    free(index->values);
+    index->keys = NULL;
+    index->values = NULL;
+    index->capacity = 0;
+    index->count = 0;
 }
 
-/* =============================== SINGLY LINKED LIST - PROMO CODES =============================== */
-void addPromoCode(const char *code, float discount) {
-    PromoCode *newCode = (PromoCode*)malloc(sizeof(PromoCode));
-    strcpy(newCode->code, code);
-    newCode->discount = discount;
-    newCode->next = NULL;
+/* =============================== HASH-INDEXED CATALOG - MENU =============================== */
+int findMenuCategory(const char *category) {
+    if (menuCatalog.categoryBuckets == NULL) return -1;
     
-    if (promoHead == NULL) {
-        promoHead = newCode;
-    } else {
-        PromoCode *current = promoHead;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = newCode;
+    int current = menuCatalog.categoryBuckets[hashString(category) & (menuCatalog.bucketCount - 1)];
+    while (current != -1) {
+        if (strcmp(menuCatalog.categories[current].name, category) == 0) return current;
+        current = menuCatalog.categories[current].nextInBucket;
     }
-    
-    printf("✓ Promo code %s added (%.0f%% discount)\n", code, discount);
+    return -1;
 }
 
-float applyPromoCode(const char *code, float total) {
-    if (promoHead == NULL) {
-        printf("No promo codes available!\n");
-        return total;
+int addMenuCategory(const char *category) {
+    if (menuCatalog.categoryCount == menuCatalog.categoryCapacity) {
+        menuCatalog.categoryCapacity = menuCatalog.categoryCapacity ? menuCatalog.categoryCapacity * 2 : 16;
+        menuCatalog.categories = (MenuCategory*)xrealloc(menuCatalog.categories,
+                                                        sizeof(MenuCategory) * menuCatalog.categoryCapacity);
     }
     
-    PromoCode *current = promoHead;
-    while (current != NULL) {
-        if (strcmp(current->code, code) == 0) {
-            float discount = total * (current->discount / 100);
-            float newTotal = total - discount;
-            printf("✓ Applied promo code %s: %.0f%% discount (-$%.2f)\n", 
-                   code, current->discount, discount);
-            return newTotal;
+    /* Rehash the name buckets whenever the category table doubles */
+    if (menuCatalog.bucketCount < menuCatalog.categoryCapacity) {
+        menuCatalog.bucketCount = menuCatalog.categoryCapacity;
+        free(menuCatalog.categoryBuckets);
+        menuCatalog.categoryBuckets = (int*)xmalloc(sizeof(int) * menuCatalog.bucketCount);
+        for (int i = 0; i < menuCatalog.bucketCount; i++) {
+            menuCatalog.categoryBuckets[i] = -1;
+        }
+        for (int i = 0; i < menuCatalog.categoryCount; i++) {
+            unsigned int bucket = hashString(menuCatalog.categories[i].name) & (menuCatalog.bucketCount - 1);
+            menuCatalog.categories[i].nextInBucket = menuCatalog.categoryBuckets[bucket];
+            menuCatalog.categoryBuckets[bucket] = i;
         }
-        current = current->next;
     }
     
-    printf("Invalid promo code!\n");
-    return total;
+    int index = menuCatalog.categoryCount++;
+    MenuCategory *newCategory = &menuCatalog.categories[index];
+    strncpy(newCategory->name, category, MAX_CATEGORY - 1);
+    newCategory->name[MAX_CATEGORY - 1] = '\0';
+    newCategory->firstSlot = -1;
+    newCategory->lastSlot = -1;
+    newCategory->itemCount = 0;
+    
+    unsigned int bucket = hashString(newCategory->name) & (menuCatalog.bucketCount - 1);
+    newCategory->nextInBucket = menuCatalog.categoryBuckets[bucket];
+    menuCatalog.categoryBuckets[bucket] = index;
+    return index;
 }
 
-void displayPromoCodes() {
-    if (promoHead == NULL) {
-        printf("No promo codes available!\n");
-        return;
-    }
-    
-    printHeader("AVAILABLE PROMO CODES");
-    printf("Code\t\tDiscount\n");
-    printf("────────────────────────\n");
-    
-    PromoCode *current = promoHead;
-    while (current != NULL) {
-        printf("%-10s\t%.0f%%\n", current->code, current->discount);
-        current = current->next;
-    }
+FoodItem* menuItemAt(int slot) {
+    return &menuCatalog.blocks[slot / MENU_BLOCK_ITEMS]->items[slot % MENU_BLOCK_ITEMS];
 }
 
-/* =============================== ORDER MANAGEMENT =============================== */
-Order* createOrder(const char *username, const char *address, const char *phone, int priority) {
-    Order *newOrder = (Order*)malloc(sizeof(Order));
-    newOrder->orderId = currentOrderId++;
-    strcpy(newOrder->username, username);
-    strcpy(newOrder->address, address);
-    strcpy(newOrder->phone, phone);
-    newOrder->items = NULL;
-    newOrder->itemCount = 0;
-    newOrder->subtotal = 0;
-    newOrder->discount = 0;
-    newOrder->deliveryFee = 2.99;
-    newOrder->tax = 0;
-    newOrder->total = 0;
-    newOrder->priority = priority;
-    newOrder->status = 0; /* Pending */
-    newOrder->orderTime = time(NULL);
-    newOrder->statusTime = time(NULL);
-    newOrder->next = NULL;
-    
-    return newOrder;
+const char* menuItemName(const FoodItem *item) {
+    return menuCatalog.blocks[item->slot / MENU_BLOCK_ITEMS]->text[item->slot % MENU_BLOCK_ITEMS].name;
 }
 
-OrderItem* createOrderItem(int itemId, const char *itemName, int quantity, float price) {
-    OrderItem *newItem = (OrderItem*)malloc(sizeof(OrderItem));
-    newItem->itemId = itemId;
-    strcpy(newItem->itemName, itemName);
-    newItem->quantity = quantity;
-    newItem->price = price;
-    newItem->prev = NULL;
-    newItem->next = NULL;
-    
-    return newItem;
+const char* menuItemCategory(const FoodItem *item) {
+    return menuCatalog.categories[item->category].name;
 }
 
-void addItemToOrder(Order *order, int itemId, const char *itemName, int quantity, float price) {
-    OrderItem *newItem = createOrderItem(itemId, itemName, quantity, price);
+FoodItem* createFoodItem(int id, const char *name, const char *category, float price, int stock) {
+    int slot = menuCatalog.count;
     
-    if (order->items == NULL) {
-        order->items = newItem;
-    } else {
-        OrderItem *current = order->items;
-        while (current->next != NULL) {
-            current = current->next;
+    /* Blocks never move once allocated, so FoodItem pointers stay valid */
+    if (slot / MENU_BLOCK_ITEMS == menuCatalog.blockCount) {
+        if (menuCatalog.blockCount == menuCatalog.blockCapacity) {
+            menuCatalog.blockCapacity = menuCatalog.blockCapacity ? menuCatalog.blockCapacity * 2 : 4;
+            menuCatalog.blocks = (MenuBlock**)xrealloc(menuCatalog.blocks,
+                                                      sizeof(MenuBlock*) * menuCatalog.blockCapacity);
         }
-        current->next = newItem;
-        newItem->prev = current;
+        menuCatalog.blocks[menuCatalog.blockCount++] = (MenuBlock*)xmalloc(sizeof(MenuBlock));
     }
     
-    order->itemCount++;
-    order->subtotal += price * quantity;
-}
-
-void displayOrderDetails(Order *order) {
-    printf("\n════════════════════════════════════════════════════════════\n");
-    printf("                    ORDER DETAILS\n");
-    printf("════════════════════════════════════════════════════════════\n");
-    printf("Order ID: #%d\n", order->orderId);
-    printf("Customer: %s\n", order->username);
-    printf("Address: %s\n", order->address);
-    printf("Phone: %s\n", order->phone);
-    printf("Order Time: %s", ctime(&order->orderTime));
-    printf("Status: %s (Updated: %s)", getStatusText(order->status), ctime(&order->statusTime));
-    printf("Priority: %s\n", getPriorityText(order->priority));
-    printf("\n────────────────────────────────────────────────────────────\n");
-    printf("ORDER ITEMS:\n");
-    printf("────────────────────────────────────────────────────────────\n");
+    int categoryIndex = findMenuCategory(category);
+    if (categoryIndex == -1) {
+        categoryIndex = addMenuCategory(category);
+    }
+    
+    MenuBlock *block = menuCatalog.blocks[slot / MENU_BLOCK_ITEMS];
+    FoodItem *newItem = &block->items[slot % MENU_BLOCK_ITEMS];
+    FoodItemText *text = &block->text[slot % MENU_BLOCK_ITEMS];
+    
+    newItem->id = id;
+    newItem->price = price;
+    newItem->stock = stock;
+    newItem->slot = slot;
+    newItem->category = categoryIndex;
+    newItem->nextInCategory = -1;
+    strncpy(text->name, name, sizeof(text->name) - 1);
+    text->name[sizeof(text->name) - 1] = '\0';
+    strcpy(text->category, menuCatalog.categories[categoryIndex].name);
     
-    if (order->items == NULL) {
-        printf("No items in order.\n");
+    /* O(1) append to the category chain */
+    MenuCategory *cat = &menuCatalog.categories[categoryIndex];
+    if (cat->lastSlot == -1) {
+        cat->firstSlot = slot;
     } else {
-        OrderItem *current = order->items;
-        int itemNum = 1;
-        
-        printf("No.\tItem\t\t\tQty\tPrice\tSubtotal\n");
-        printf("────────────────────────────────────────────────────────────\n");
-        
-        while (current != NULL) {
-            float subtotal = current->price * current->quantity;
-            printf("%d.\t%-20s\t%d\t$%.2f\t$%.2f\n", 
-                   itemNum++, current->itemName, current->quantity, current->price, subtotal);
-            current = current->next;
-        }
+        menuItemAt(cat->lastSlot)->nextInCategory = slot;
     }
+    cat->lastSlot = slot;
+    cat->itemCount++;
     
-    printf("\n────────────────────────────────────────────────────────────\n");
-    printf("ORDER SUMMARY:\n");
-    printf("────────────────────────────────────────────────────────────\n");
-    printf("Subtotal: $%.2f\n", order->subtotal);
-    printf("Discount: -$%.2f\n", order->discount);
-    printf("Delivery Fee: $%.2f\n", order->deliveryFee);
-    printf("Tax (8%%): $%.2f\n", order->tax);
-    printf("────────────────────────────────────────────────────────────\n");
-    printf("TOTAL: $%.2f\n", order->total);
-    printf("════════════════════════════════════════════════════════════\n");
+    idIndexPut(&menuCatalog.idIndex, id, slot);
+    indexMenuItemName(slot, text->name);
+    menuCatalog.count++;
+    return newItem;
 }
 
-void updateOrderStatus(Order *order, int newStatus) {
-    order->status = newStatus;
-    order->statusTime = time(NULL);
+void addToMenu(const char *name, const char *category, float price, int stock) {
+    if (menuCatalog.nextId == 0) menuCatalog.nextId = 1;
+    createFoodItem(menuCatalog.nextId++, name, category, price, stock);
+    notify("✓ Added: %s ($%.2f) to %s category\n", name, price, category);
 }
 
-/* =============================== STACK - ORDER PROCESSING =============================== */
-void pushOrder(Order order) {
-    OrderStack *newOrder = (OrderStack*)malloc(sizeof(OrderStack));
-    newOrder->order = order;
-    newOrder->next = orderStackTop;
-    orderStackTop = newOrder;
+void displayAllMenu() {
+    printHeader("MENU - ALL ITEMS");
     
-    printf("✓ Order #%d placed successfully!\n", order.orderId);
+    for (int c = 0; c < menuCatalog.categoryCount; c++) {
+        MenuCategory *cat = &menuCatalog.categories[c];
+        if (c > 0) {
+            screenPrintf("\n");
+        }
+        screenPrintf("\n【 %s 】\n", cat->name);
+        screenPrintf("ID\tName\t\t\tPrice\tStock\n");
+        screenPrintf("────────────────────────────────────────────────\n");
+        
+        for (int slot = cat->firstSlot; slot != -1; slot = menuItemAt(slot)->nextInCategory) {
+            FoodItem *current = menuItemAt(slot);
+            screenPrintf("%d\t%-20s\t$%.2f\t%d\n", 
+                         current->id, menuItemName(current), current->price, current->stock);
+        }
+    }
+    screenFlush();
 }
 
-Order popOrder() {
-    Order emptyOrder = {0};
-    
-    if (orderStackTop == NULL) {
-        printf("No orders to process!\n");
-        return emptyOrder;
+/* ---- Menu search: sorted name order for prefixes, trigram postings for substrings ---- */
+static int foldedCompare(const char *a, const char *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int ca = tolower((unsigned char)a[i]);
+        int cb = tolower((unsigned char)b[i]);
+        if (ca != cb || ca == '\0') return ca - cb;
     }
-    
-    OrderStack *temp = orderStackTop;
-    Order order = temp->order;
-    orderStackTop = orderStackTop->next;
-    
-    free(temp);
-    return order;
+    return 0;
 }
 
-void displayOrderStack() {
-    if (orderStackTop == NULL) {
-        printf("No pending orders!\n");
-        return;
+static int containsFolded(const char *haystack, const char *needle, size_t needleLength) {
+    for (; *haystack != '\0'; haystack++) {
+        if (foldedCompare(haystack, needle, needleLength) == 0) return 1;
     }
-    
-    printHeader("PENDING ORDERS (STACK)");
-    printf("Order ID\tCustomer\t\tStatus\t\t\tTotal\tTime\n");
-    printf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
-    
-    OrderStack *current = orderStackTop;
-    while (current != NULL) {
-        printf("#%d\t\t%-15s\t%-20s\t$%.2f\t%s", 
-               current->order.orderId, current->order.username, 
-               getStatusText(current->order.status), current->order.total, 
-               ctime(&current->order.orderTime));
-        current = current->next;
+    return needleLength == 0;
+}
+
+static int trigramKey(const char *text) {
+    return tolower((unsigned char)text[0]) << 16 |
+           tolower((unsigned char)text[1]) << 8 |
+           tolower((unsigned char)text[2]);
+}
+
+/* Adds the slot to the posting of every trigram in its name */
+void indexMenuItemName(int slot, const char *name) {
+    for (size_t i = 0; name[i] != '\0' && name[i + 1] != '\0' && name[i + 2] != '\0'; i++) {
+        int key = trigramKey(name + i);
+        int posting = idIndexGet(&menuCatalog.trigramIndex, key);
+        if (posting == -1) {
+            if (menuCatalog.postingCount == menuCatalog.postingCapacity) {
+                menuCatalog.postingCapacity = menuCatalog.postingCapacity ? menuCatalog.postingCapacity * 2 : 256;
+                menuCatalog.postings = (MenuPosting*)xrealloc(menuCatalog.postings,
+                                                              sizeof(MenuPosting) * menuCatalog.postingCapacity);
+            }
+            posting = menuCatalog.postingCount++;
+            menuCatalog.postings[posting] = (MenuPosting){NULL, 0, 0};
+            idIndexPut(&menuCatalog.trigramIndex, key, posting);
+        }
+        
+        MenuPosting *list = &menuCatalog.postings[posting];
+        if (list->count > 0 && list->slots[list->count - 1] == slot) continue;   /* Repeated trigram */
+        if (list->count == list->capacity) {
+            list->capacity = list->capacity ? list->capacity * 2 : 4;
+            list->slots = (int*)xrealloc(list->slots, sizeof(int) * list->capacity);
+        }
+        list->slots[list->count++] = slot;
     }
 }
 
-/* =============================== QUEUE - DELIVERY SYSTEM =============================== */
-void enqueueDelivery(Order order) {
-    Delivery *newDelivery = (Delivery*)malloc(sizeof(Delivery));
-    newDelivery->order = order;
-    newDelivery->next = NULL;
+static int compareSlotNames(const void *a, const void *b) {
+    int slotA = *(const int*)a, slotB = *(const int*)b;
+    int cmp = foldedCompare(menuItemName(menuItemAt(slotA)), menuItemName(menuItemAt(slotB)),
+                            sizeof(((FoodItemText*)0)->name));
+    return cmp != 0 ? cmp : slotA - slotB;
+}
+
+/* Items are added far less often than searched, so the order is re-sorted lazily */
+static void refreshNameOrder() {
+    if (menuCatalog.nameOrderCount == menuCatalog.count) return;
     
-    if (deliveryRear == NULL) {
-        deliveryFront = deliveryRear = newDelivery;
-    } else {
-        /* Priority-based insertion */
-        if (order.priority > deliveryFront->order.priority) {
-            /* Insert at front for highest priority */
-            newDelivery->next = deliveryFront;
-            deliveryFront = newDelivery;
+    menuCatalog.nameOrder = (int*)xrealloc(menuCatalog.nameOrder, sizeof(int) * (menuCatalog.count + 1));
+    for (int slot = menuCatalog.nameOrderCount; slot < menuCatalog.count; slot++) {
+        menuCatalog.nameOrder[slot] = slot;
+    }
+    qsort(menuCatalog.nameOrder, menuCatalog.count, sizeof(int), compareSlotNames);
+    menuCatalog.nameOrderCount = menuCatalog.count;
+}
+
+/* Binary search for the first name with the prefix, then a contiguous run */
+int searchMenuByPrefix(const char *prefix, int *slots, int max) {
+    refreshNameOrder();
+    size_t length = strlen(prefix);
+    int low = 0, high = menuCatalog.count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (foldedCompare(menuItemName(menuItemAt(menuCatalog.nameOrder[mid])), prefix, length) < 0) {
+            low = mid + 1;
         } else {
-            /* Find correct position */
-            Delivery *current = deliveryFront;
-            Delivery *prev = NULL;
-            
-            while (current != NULL && current->order.priority >= order.priority) {
-                prev = current;
-                current = current->next;
-            }
-            
-            if (prev == NULL) {
-                newDelivery->next = deliveryFront;
-                deliveryFront = newDelivery;
-            } else {
-                newDelivery->next = current;
-                prev->next = newDelivery;
-                
-                if (newDelivery->next == NULL) {
-                    deliveryRear = newDelivery;
-                }
-            }
+            high = mid;
         }
     }
     
-    printf("✓ Delivery queued for Order #%d\n", order.orderId);
+    int found = 0;
+    for (int i = low; i < menuCatalog.count && found < max; i++) {
+        if (foldedCompare(menuItemName(menuItemAt(menuCatalog.nameOrder[i])), prefix, length) != 0) break;
+        slots[found++] = menuCatalog.nameOrder[i];
+    }
+    return found;
 }
 
-Order dequeueDelivery() {
-    Order emptyOrder = {0};
+/* Candidates come from the rarest query trigram and are verified against the name */
+int searchMenuBySubstring(const char *text, int *slots, int max) {
+    size_t length = strlen(text);
+    int found = 0;
     
-    if (deliveryFront == NULL) {
-        printf("No deliveries pending!\n");
-        return emptyOrder;
+    if (length < 3) {
+        for (int slot = 0; slot < menuCatalog.count && found < max; slot++) {
+            if (containsFolded(menuItemName(menuItemAt(slot)), text, length)) slots[found++] = slot;
+        }
+        return found;
     }
     
-    Delivery *temp = deliveryFront;
-    Order order = temp->order;
-    deliveryFront = deliveryFront->next;
+    MenuPosting *rarest = NULL;
+    for (size_t i = 0; i + 3 <= length; i++) {
+        int posting = idIndexGet(&menuCatalog.trigramIndex, trigramKey(text + i));
+        if (posting == -1) return 0;
+        if (rarest == NULL || menuCatalog.postings[posting].count < rarest->count) {
+            rarest = &menuCatalog.postings[posting];
+        }
+    }
     
-    if (deliveryFront == NULL) {
-        deliveryRear = NULL;
+    for (int i = 0; i < rarest->count && found < max; i++) {
+        int slot = rarest->slots[i];
+        if (length == 3 || containsFolded(menuItemName(menuItemAt(slot)), text, length)) {
+            slots[found++] = slot;
+        }
     }
+    return found;
+}
+
+int searchMenuByCategory(const char *category, int *slots, int max) {
+    int index = findMenuCategory(category);
+    if (index == -1) return 0;
     
-    free(temp);
-    return order;
+    int found = 0;
+    for (int slot = menuCatalog.categories[index].firstSlot; slot != -1 && found < max;
+         slot = menuItemAt(slot)->nextInCategory) {
+        slots[found++] = slot;
+    }
+    return found;
 }
 
-void displayDeliveryQueue() {
-    if (deliveryFront == NULL) {
-        printf("No deliveries in queue!\n");
+/* mode: 1 = name prefix, 2 = name contains, 3 = category */
+void displayMenuSearch(int mode, const char *query) {
+    int slots[MENU_SEARCH_MAX];
+    double start = benchNow();
+    int found = mode == 1 ? searchMenuByPrefix(query, slots, MENU_SEARCH_MAX)
+              : mode == 2 ? searchMenuBySubstring(query, slots, MENU_SEARCH_MAX)
+              : searchMenuByCategory(query, slots, MENU_SEARCH_MAX);
+    double elapsed = benchNow() - start;
+    
+    if (found == 0) {
+        screenPrintf("No items match \"%s\".\n", query);
+        screenFlush();
         return;
     }
-    
-    printHeader("DELIVERY QUEUE");
-    printf("Position\tOrder ID\tCustomer\t\tStatus\t\t\tPriority\n");
-    printf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
-    
-    Delivery *current = deliveryFront;
-    int position = 1;
-    
-    while (current != NULL) {
-        printf("%d\t\t#%d\t\t%-15s\t%-20s\t%s\n", 
-               position++, current->order.orderId, current->order.username,
-               getStatusText(current->order.status), getPriorityText(current->order.priority));
-        current = current->next;
+    screenPrintf("ID\tName\t\t\tCategory\tPrice\tStock\n");
+    screenPrintf("────────────────────────────────────────────────────────────────\n");
+    for (int i = 0; i < found; i++) {
+        FoodItem *item = menuItemAt(slots[i]);
+        screenPrintf("%d\t%-20s\t%-12s\t$%.2f\t%d\n", item->id, menuItemName(item),
+                     menuCatalog.categories[item->category].name, item->price, item->stock);
     }
+    screenPrintf("\n%d item(s)%s, found in %.1f µs\n", found,
+                 found == MENU_SEARCH_MAX ? " (first page)" : "", elapsed * 1e6);
+    screenFlush();
 }
 
-/* =============================== BST - USER MANAGEMENT =============================== */
-User* createUser(const char *username, const char *password, const char *address, const char *phone) {
-    User *newUser = (User*)malloc(sizeof(User));
-    strcpy(newUser->username, username);
-    strcpy(newUser->password, password);
-    strcpy(newUser->address, address);
-    strcpy(newUser->phone, phone);
-    newUser->loyaltyPoints = 0;
-    newUser->left = NULL;
-    newUser->right = NULL;
-    return newUser;
+FoodItem* findMenuItem(int id) {
+    int slot = idIndexGet(&menuCatalog.idIndex, id);
+    return slot == -1 ? NULL : menuItemAt(slot);
 }
 
-User* insertUser(User *root, User *newUser) {
-    if (root == NULL) {
-        return newUser;
-    }
-    
-    int cmp = strcmp(newUser->username, root->username);
-    
-    if (cmp < 0) {
-        root->left = insertUser(root->left, newUser);
-    } else if (cmp > 0) {
-        root->right = insertUser(root->right, newUser);
-    } else {
-        printf("✗ Username already exists!\n");
-        free(newUser);
-        return root;
+/* Atomic check-and-decrement: never lets stock go below zero */
+int reserveStock(FoodItem *item, int quantity) {
+    int current = atomic_load(&item->stock);
+    while (current >= quantity) {
+        if (atomic_compare_exchange_weak(&item->stock, &current, current - quantity)) {
+            return 1;
+        }
     }
-    
-    return root;
+    return 0;
 }
 
-User* searchUser(User *root, const char *username) {
-    if (root == NULL || strcmp(root->username, username) == 0) {
-        return root;
-    }
-    
-    if (strcmp(username, root->username) < 0) {
-        return searchUser(root->left, username);
-    }
-    
-    return searchUser(root->right, username);
+void releaseStock(FoodItem *item, int quantity) {
+    atomic_fetch_add(&item->stock, quantity);
 }
 
-void displayUsersInorder(User *root) {
-    if (root != NULL) {
-        displayUsersInorder(root->left);
-        printf("%-15s\t%-30s\t%s\t%d points\n", 
-               root->username, root->address, root->phone, root->loyaltyPoints);
-        displayUsersInorder(root->right);
+/* =============================== DOUBLY LINKED LIST - SHOPPING CART =============================== */
+Cart* createCart() {
+    Cart *cart = (Cart*)slabAlloc(&cartPool);
+    cart->head = cart->tail = NULL;
+    cart->lineCount = 0;
+    cart->itemCount = 0;
+    cart->subtotalCents = 0;
+    cart->nextFree = NULL;
+    /* buckets: a reused cart keeps its cleared index, a fresh one is NULL */
+    return cart;
+}
+
+/* A small bucket array stays with the pooled cart, so the next cart needs no allocation */
+void destroyCart(Cart *cart) {
+    if (cart->bucketCount > CART_POOLED_BUCKETS) {
+        free(cart->buckets);
+        cart->buckets = NULL;
+        cart->bucketCount = 0;
     }
+    clearCart(cart);
+    slabFree(&cartPool, cart);
 }
 
-void addLoyaltyPoints(const char *username, float purchaseAmount) {
-    User *user = searchUser(userRoot, username);
-    if (user != NULL) {
-        int points = (int)(purchaseAmount * 10);
-        user->loyaltyPoints += points;
-        printf("✓ Added %d loyalty points to %s\n", points, username);
+/* Frees the bucket arrays of every cart, live or pooled, before the pool itself */
+void releaseCartPool() {
+    for (int b = 0; b < cartPool.blockCount; b++) {
+        Cart *carts = (Cart*)cartPool.blocks[b];
+        for (int i = 0; i < SLAB_BLOCK_NODES; i++) {
+            free(carts[i].buckets);
+        }
     }
+    slabRelease(&cartPool);
 }
 
-/* =============================== AVL TREE - ORDER HISTORY =============================== */
-int height(OrderHistory *node) {
-    return node ? node->height : 0;
+static long long lineCents(float price, int quantity) {
+    return (long long)(price * 100.0f + 0.5f) * quantity;
 }
 
-int maxInt(int a, int b) {
-    return (a > b) ? a : b;
+static CartItem** cartBucket(Cart *cart, int itemId) {
+    return &cart->buckets[hashInt(itemId) & (cart->bucketCount - 1)];
 }
 
-OrderHistory* rightRotateAVL(OrderHistory *y) {
-    OrderHistory *x = y->left;
-    OrderHistory *T2 = x->right;
-    
-    x->right = y;
-    y->left = T2;
+/* Keeps at most one line per bucket on average */
+static void cartIndexGrow(Cart *cart) {
+    free(cart->buckets);
+    cart->bucketCount = cart->bucketCount ? cart->bucketCount * 2 : CART_MIN_BUCKETS;
+    cart->buckets = (CartItem**)xcalloc(cart->bucketCount, sizeof(CartItem*));
     
-    y->height = maxInt(height(y->left), height(y->right)) + 1;
-    x->height = maxInt(height(x->left), height(x->right)) + 1;
+    for (CartItem *line = cart->head; line != NULL; line = line->next) {
+        CartItem **bucket = cartBucket(cart, line->itemId);
+        line->nextInBucket = *bucket;
+        *bucket = line;
+    }
+}
+
+CartItem* findCartLine(Cart *cart, int itemId) {
+    if (cart->bucketCount == 0) return NULL;
     
-    return x;
+    for (CartItem *line = *cartBucket(cart, itemId); line != NULL; line = line->nextInBucket) {
+        if (line->itemId == itemId) {
+            return line;
+        }
+    }
+    return NULL;
 }
 
-OrderHistory* leftRotateAVL(OrderHistory *x) {
-    OrderHistory *y = x->right;
-    OrderHistory *T2 = y->left;
+int addToCart(Cart *cart, int itemId, int quantity) {
+    FoodItem *item = findMenuItem(itemId);
+    if (item == NULL) {
+        notify("Item not found!\n");
+        return 0;
+    }
     
-    y->left = x;
-    x->right = T2;
+    /* Same item again: merge into its line, checking stock for the total */
+    CartItem *existing = findCartLine(cart, itemId);
+    int merged = quantity + (existing != NULL ? existing->quantity : 0);
+    if (item->stock < merged) {
+        notify("Insufficient stock! Only %d available.\n", item->stock);
+        return 0;
+    }
     
-    x->height = maxInt(height(x->left), height(x->right)) + 1;
-    y->height = maxInt(height(y->left), height(y->right)) + 1;
+    cart->itemCount += quantity;
+    if (existing != NULL) {
+        existing->quantity = merged;
+        cart->subtotalCents += lineCents(existing->price, quantity);
+        notify("✓ Added %d x %s to cart\n", quantity, menuItemName(item));
+        return 1;
+    }
     
-    return y;
-}
-
-int getBalanceAVL(OrderHistory *node) {
-    return node ? height(node->left) - height(node->right) : 0;
-}
-
-OrderHistory* createOrderHistory(Order order) {
-    OrderHistory *newNode = (OrderHistory*)malloc(sizeof(OrderHistory));
-    newNode->order = order;
-    newNode->height = 1;
-    newNode->left = NULL;
-    newNode->right = NULL;
-    return newNode;
-}
-
-OrderHistory* insertOrderHistory(OrderHistory *node, Order order) {
-    if (node == NULL) {
-        return createOrderHistory(order);
+    if (cart->lineCount >= cart->bucketCount) {
+        cartIndexGrow(cart);
     }
     
-    if (order.orderId < node->order.orderId) {
-        node->left = insertOrderHistory(node->left, order);
-    } else if (order.orderId > node->order.orderId) {
-        node->right = insertOrderHistory(node->right, order);
+    CartItem *newItem = (CartItem*)slabAlloc(&cartItemPool);
+    newItem->itemId = itemId;
+    strcpy(newItem->itemName, menuItemName(item));
+    newItem->quantity = quantity;
+    newItem->price = item->price;
+    newItem->prev = NULL;
+    newItem->next = NULL;
+    
+    if (cart->head == NULL) {
+        cart->head = cart->tail = newItem;
     } else {
-        return node;
+        cart->tail->next = newItem;
+        newItem->prev = cart->tail;
+        cart->tail = newItem;
+    }
+    CartItem **bucket = cartBucket(cart, itemId);
+    newItem->nextInBucket = *bucket;
+    *bucket = newItem;
+    cart->lineCount++;
+    cart->subtotalCents += lineCents(newItem->price, quantity);
+    
+    notify("✓ Added %d x %s to cart\n", quantity, menuItemName(item));
+    return 1;
+}
+
+void displayCart(Cart *cart) {
+    if (cart->head == NULL) {
+        screenPrintf("Your cart is empty!\n");
+        screenFlush();
+        return;
     }
     
-    node->height = 1 + maxInt(height(node->left), height(node->right));
+    printHeader("SHOPPING CART");
+    screenPrintf("Item\t\t\tQuantity\tPrice\tSubtotal\n");
+    screenPrintf("────────────────────────────────────────────────────────────\n");
     
-    int balance = getBalanceAVL(node);
+    CartItem *current = cart->head;
+    while (current != NULL) {
+        float subtotal = current->price * current->quantity;
+        screenPrintf("%-20s\t%d\t\t$%.2f\t$%.2f\n", 
+                     current->itemName, current->quantity, current->price, subtotal);
+        current = current->next;
+    }
     
-    if (balance > 1 && order.orderId < node->left->order.orderId) {
-        return rightRotateAVL(node);
+    screenPrintf("────────────────────────────────────────────────────────────\n");
+    screenPrintf("Total Items: %d\t\t\t\tTotal: $%.2f\n", cartItemCount(cart), calculateCartTotal(cart));
+    screenFlush();
+}
+
+int removeFromCart(Cart *cart, int itemId) {
+    if (cart->bucketCount == 0) {
+        notify("Item not found in cart!\n");
+        return 0;
     }
     
-    if (balance < -1 && order.orderId > node->right->order.orderId) {
-        return leftRotateAVL(node);
+    /* Unlink from the index chain, then from the display order */
+    CartItem **link = cartBucket(cart, itemId);
+    while (*link != NULL && (*link)->itemId != itemId) {
+        link = &(*link)->nextInBucket;
     }
+    CartItem *current = *link;
+    if (current == NULL) {
+        notify("Item not found in cart!\n");
+        return 0;
+    }
+    *link = current->nextInBucket;
     
-    if (balance > 1 && order.orderId > node->left->order.orderId) {
-        node->left = leftRotateAVL(node->left);
-        return rightRotateAVL(node);
+    if (current->prev != NULL) {
+        current->prev->next = current->next;
+    } else {
+        cart->head = current->next;
     }
     
-    if (balance < -1 && order.orderId < node->right->order.orderId) {
-        node->right = rightRotateAVL(node->right);
-        return leftRotateAVL(node);
+    if (current->next != NULL) {
+        current->next->prev = current->prev;
+    } else {
+        cart->tail = current->prev;
     }
     
-    return node;
+    notify("Removed %s from cart\n", current->itemName);
+    cart->lineCount--;
+    cart->itemCount -= current->quantity;
+    cart->subtotalCents -= lineCents(current->price, current->quantity);
+    slabFree(&cartItemPool, current);
+    return 1;
 }
 
-void displayOrderHistoryInorder(OrderHistory *root) {
-    if (root != NULL) {
-        displayOrderHistoryInorder(root->left);
-        printf("#%d\t\t%s\t\t%s\t\t$%.2f\t%s", 
-               root->order.orderId, root->order.username, 
-               getStatusText(root->order.status), root->order.total, 
-               ctime(&root->order.orderTime));
-        displayOrderHistoryInorder(root->right);
+void clearCart(Cart *cart) {
+    /* The item chain goes back to the pool in one splice */
+    slabFreeChain(&cartItemPool, cart->head, cart->tail, cart->lineCount);
+    
+    cart->head = cart->tail = NULL;
+    cart->lineCount = 0;
+    cart->itemCount = 0;
+    cart->subtotalCents = 0;
+    if (cart->buckets != NULL) {
+        memset(cart->buckets, 0, sizeof(CartItem*) * cart->bucketCount);
     }
+    notify("Cart cleared!\n");
+}
+
+float calculateCartTotal(Cart *cart) {
+    return cart->subtotalCents / 100.0f;
+}
+
+int cartItemCount(Cart *cart) {
+    return cart->itemCount;
+}
+
+/* =============================== SESSION =============================== */
+Session* openSession(User *user) {
+    Session *session = (Session*)xmalloc(sizeof(Session));
+    session->user = user;
+    session->cart = createCart();
+    session->token[0] = '\0';
+    return session;
+}
+
+/* Re-enters by token alone, without re-hashing the password. Keeps current (and its
+ * cart) if it already holds the token, otherwise replaces it; NULL if the token is
+ * unknown, expired or revoked, leaving current as it was */
+Session* resumeSession(const char *tokenHex, Session *current) {
+    User *user = authenticateToken(tokenHex);
+    if (user == NULL) return NULL;
+    if (current != NULL && strcmp(current->token, tokenHex) == 0) return current;
+    
+    if (current != NULL) closeSession(current);
+    Session *session = openSession(user);
+    strcpy(session->token, tokenHex);     /* authenticateToken checked the length */
+    return session;
+}
+
+void closeSession(Session *session) {
+    if (session->token[0] != '\0') revokeSessionToken(session->token);
+    destroyCart(session->cart);
+    free(session);
+}
+
+/* =============================== HASHED PROMO TABLE - PROMO CODES =============================== */
+PromoCode* promoAt(int slot) {
+    return &promoTable.blocks[slot / PROMO_BLOCK_CODES][slot % PROMO_BLOCK_CODES];
 }
 
-OrderHistory* searchOrderHistoryById(OrderHistory *root, int orderId) {
-    if (root == NULL || root->order.orderId == orderId) {
-        return root;
+/* Caller holds promoTable.lock */
+static int findPromoSlotLocked(const char *code) {
+    if (promoTable.slots == NULL) return -1;
+    
+    unsigned int mask = (unsigned int)promoTable.slotCapacity - 1;
+    for (unsigned int pos = hashString(code) & mask; promoTable.slots[pos] != -1; pos = (pos + 1) & mask) {
+        if (strcmp(promoAt(promoTable.slots[pos])->code, code) == 0) return promoTable.slots[pos];
     }
+    return -1;
+}
+
+int findPromoSlot(const char *code) {
+    pthread_rwlock_rdlock(&promoTable.lock);
+    int slot = findPromoSlotLocked(code);
+    pthread_rwlock_unlock(&promoTable.lock);
+    return slot;
+}
+
+/* Caller holds promoTable.lock exclusively; rehashes so count codes fit under 50% load */
+static void reservePromoCapacityLocked(int count) {
+    if (count * 2 <= promoTable.slotCapacity) return;
     
-    if (orderId < root->order.orderId) {
-        return searchOrderHistoryById(root->left, orderId);
+    int capacity = promoTable.slotCapacity ? promoTable.slotCapacity : 64;
+    while (count * 2 > capacity) capacity *= 2;
+    free(promoTable.slots);
+    promoTable.slots = (int*)xmalloc(sizeof(int) * capacity);
+    promoTable.slotCapacity = capacity;
+    for (int i = 0; i < capacity; i++) {
+        promoTable.slots[i] = -1;
     }
     
-    return searchOrderHistoryById(root->right, orderId);
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int slot = 0; slot < promoTable.count; slot++) {
+        unsigned int pos = hashString(promoAt(slot)->code) & mask;
+        while (promoTable.slots[pos] != -1) pos = (pos + 1) & mask;
+        promoTable.slots[pos] = slot;
+    }
+}
+
+void reservePromoCapacity(int count) {
+    pthread_rwlock_wrlock(&promoTable.lock);
+    reservePromoCapacityLocked(count);
+    pthread_rwlock_unlock(&promoTable.lock);
 }
 
-void displayUserOrderHistory(OrderHistory *root, const char *username) {
-    if (root != NULL) {
-        displayUserOrderHistory(root->left, username);
-        if (strcmp(root->order.username, username) == 0) {
-            printf("#%d\t\t%s\t\t$%.2f\t%s", 
-                   root->order.orderId, getStatusText(root->order.status), 
-                   root->order.total, ctime(&root->order.orderTime));
+/* Adds a code, or redefines an existing one while keeping its usage count */
+PromoCode* insertPromoCode(const char *code, float discount, time_t validFrom, time_t validUntil,
+                           int maxUses, int maxUsesPerCustomer) {
+    pthread_rwlock_wrlock(&promoTable.lock);
+    char key[sizeof(((PromoCode*)0)->code)];
+    strncpy(key, code, sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+    
+    int slot = findPromoSlotLocked(key);
+    if (slot == -1) {
+        if (promoTable.count == PROMO_MAX_BLOCKS * PROMO_BLOCK_CODES) {
+            pthread_rwlock_unlock(&promoTable.lock);
+            fprintf(stderr, "Promo table full\n");
+            return NULL;
+        }
+        reservePromoCapacityLocked(promoTable.count + 1);
+        
+        slot = promoTable.count;
+        if (slot / PROMO_BLOCK_CODES == promoTable.blockCount) {
+            promoTable.blocks[promoTable.blockCount++] = (PromoCode*)xmalloc(sizeof(PromoCode) * PROMO_BLOCK_CODES);
         }
-        displayUserOrderHistory(root->right, username);
+        PromoCode *newCode = promoAt(slot);
+        strcpy(newCode->code, key);
+        atomic_init(&newCode->uses, 0);
+        
+        unsigned int mask = (unsigned int)promoTable.slotCapacity - 1;
+        unsigned int pos = hashString(key) & mask;
+        while (promoTable.slots[pos] != -1) pos = (pos + 1) & mask;
+        promoTable.slots[pos] = slot;
+        promoTable.count++;
     }
+    
+    PromoCode *promo = promoAt(slot);
+    promo->discount = discount;
+    promo->validFrom = validFrom;
+    promo->validUntil = validUntil;
+    promo->maxUses = maxUses;
+    promo->maxUsesPerCustomer = maxUsesPerCustomer;
+    pthread_rwlock_unlock(&promoTable.lock);
+    return promo;
 }
 
-/* =============================== ORDER TRACKING FUNCTIONS =============================== */
-Order* searchOrderById(int orderId) {
-    /* Search in order stack */
-    OrderStack *stackCurrent = orderStackTop;
-    while (stackCurrent != NULL) {
-        if (stackCurrent->order.orderId == orderId) {
-            return &(stackCurrent->order);
+void addPromoCode(const char *code, float discount, int validDays, int maxUses, int maxUsesPerCustomer) {
+    time_t validUntil = validDays > 0 ? time(NULL) + (time_t)validDays * 86400 : 0;
+    if (insertPromoCode(code, discount, 0, validUntil, maxUses, maxUsesPerCustomer) == NULL) return;
+    notify("✓ Promo code %s added (%.0f%% discount)\n", code, discount);
+}
+
+/* Bulk load of CODE,PERCENT[,FROM,UNTIL,MAX_USES,PER_CUSTOMER[,USES]] lines.
+ * The table is sized once up front, so no insert triggers a rehash. */
+int importPromoCodes(FILE *file) {
+    char line[256];
+    long start = ftell(file);
+    if (start != -1) {
+        int lines = 0;
+        while (fgets(line, sizeof(line), file) != NULL) lines++;
+        if (fseek(file, start, SEEK_SET) == 0) {
+            reservePromoCapacity(promoTable.count + lines);
         }
-        stackCurrent = stackCurrent->next;
     }
     
-    /* Search in delivery queue */
-    Delivery *queueCurrent = deliveryFront;
-    while (queueCurrent != NULL) {
-        if (queueCurrent->order.orderId == orderId) {
-            return &(queueCurrent->order);
+    int imported = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char code[20];
+        float discount;
+        long long validFrom = 0, validUntil = 0;
+        int maxUses = 0, maxUsesPerCustomer = 0, uses = 0;
+        if (sscanf(line, "%19[^,\n],%f,%lld,%lld,%d,%d,%d", code, &discount, &validFrom, &validUntil,
+                   &maxUses, &maxUsesPerCustomer, &uses) < 2) {
+            continue;
         }
-        queueCurrent = queueCurrent->next;
+        
+        PromoCode *promo = insertPromoCode(code, discount, (time_t)validFrom, (time_t)validUntil,
+                                           maxUses, maxUsesPerCustomer);
+        if (promo == NULL) break;
+        atomic_store(&promo->uses, uses);
+        imported++;
     }
-    
-    /* Search in history (AVL tree) */
-    OrderHistory *historyNode = searchOrderHistoryById(historyRoot, orderId);
-    if (historyNode != NULL) {
-        return &(historyNode->order);
+    return imported;
+}
+
+static void initRedemptionStripes(void) {
+    for (int i = 0; i < PROMO_REDEMPTION_STRIPES; i++) {
+        pthread_mutex_init(&redemptionStripes[i].lock, NULL);
     }
-    
-    return NULL;
 }
 
-void displayOrderStatus(int orderId, const char *username, int isAdmin) {
-    printHeader("ORDER TRACKING");
+static unsigned int redemptionHash(int promo, const char *username) {
+    return hashString(username) * 31u + hashInt(promo);
+}
+
+/* Finds or adds the customer's counter for a code.
+ * Counters never move, so the caller updates them after the stripe is unlocked. */
+_Atomic int* redemptionCounter(int promo, const char *username) {
+    static pthread_once_t stripesReady = PTHREAD_ONCE_INIT;
+    pthread_once(&stripesReady, initRedemptionStripes);
     
-    Order *order = searchOrderById(orderId);
-    if (order == NULL) {
-        printf("Order #%d not found!\n", orderId);
-        return;
-    }
+    unsigned int hash = redemptionHash(promo, username);
+    RedemptionStripe *stripe = &redemptionStripes[hash % PROMO_REDEMPTION_STRIPES];
+    pthread_mutex_lock(&stripe->lock);
     
-    /* Check if user is authorized to view this order */
-    if (!isAdmin && strcmp(order->username, username) != 0) {
-        printf("Access denied! You can only view your own orders.\n");
-        return;
+    PromoRedemption *found = NULL;
+    if (stripe->bucketCount > 0) {
+        found = stripe->buckets[(hash / PROMO_REDEMPTION_STRIPES) & (stripe->bucketCount - 1)];
+        while (found != NULL && (found->promo != promo || strcmp(found->username, username) != 0)) {
+            found = found->next;
+        }
     }
     
-    displayOrderDetails(order);
-    
-    /* Show delivery progress */
-    printf("\nDELIVERY PROGRESS:\n");
-    printf("[");
-    for (int i = 0; i <= 4; i++) {
-        if (order->status >= i) {
-            printf("█");
-        } else {
-            printf("░");
+    if (found == NULL) {
+        if (stripe->count >= stripe->bucketCount) {
+            /* Double the buckets and rechain */
+            int bucketCount = stripe->bucketCount ? stripe->bucketCount * 2 : 16;
+            PromoRedemption **buckets = (PromoRedemption**)xcalloc(bucketCount, sizeof(PromoRedemption*));
+            for (int b = 0; b < stripe->bucketCount; b++) {
+                PromoRedemption *node = stripe->buckets[b];
+                while (node != NULL) {
+                    PromoRedemption *next = node->next;
+                    unsigned int h = redemptionHash(node->promo, node->username) / PROMO_REDEMPTION_STRIPES;
+                    node->next = buckets[h & (bucketCount - 1)];
+                    buckets[h & (bucketCount - 1)] = node;
+                    node = next;
+                }
+            }
+            free(stripe->buckets);
+            stripe->buckets = buckets;
+            stripe->bucketCount = bucketCount;
         }
+        
+        found = (PromoRedemption*)slabAlloc(&redemptionPool);
+        found->promo = promo;
+        atomic_init(&found->count, 0);
+        strncpy(found->username, username, sizeof(found->username) - 1);
+        found->username[sizeof(found->username) - 1] = '\0';
+        PromoRedemption **bucket = &stripe->buckets[(hash / PROMO_REDEMPTION_STRIPES) & (stripe->bucketCount - 1)];
+        found->next = *bucket;
+        *bucket = found;
+        stripe->count++;
     }
-    printf("]\n");
-    
-    /* Show status timeline */
-    printf("\nSTATUS TIMELINE:\n");
-    printf("1. Order Placed: %s", order->status >= 0 ? "✓ Completed\n" : "○ Pending\n");
-    printf("2. Order Confirmed: %s", order->status >= 1 ? "✓ Completed\n" : "○ Pending\n");
-    printf("3. Food Preparation: %s", order->status >= 2 ? "✓ Completed\n" : "○ Pending\n");
-    printf("4. Out for Delivery: %s", order->status >= 3 ? "✓ Completed\n" : "○ Pending\n");
-    printf("5. Order Delivered: %s", order->status >= 4 ? "✓ Completed\n" : "○ Pending\n");
     
-    /* Estimated delivery time */
-    printf("\nESTIMATED DELIVERY TIME:\n");
-    time_t estimatedTime = order->orderTime;
-    switch(order->priority) {
-        case 1: estimatedTime += 4 * 3600; break;  /* 4 hours */
-        case 2: estimatedTime += 2 * 3600; break;  /* 2 hours */
-        case 3: estimatedTime += 1 * 3600; break;  /* 1 hour */
-        case 4: estimatedTime += 1800; break;      /* 30 minutes */
+    pthread_mutex_unlock(&stripe->lock);
+    return &found->count;
+}
+
+/* Atomic check-and-increment against a limit; 0 = unlimited.
+ * Returns the new count, or 0 when the limit is reached. */
+static int reservePromoUse(_Atomic int *uses, int limit) {
+    if (limit <= 0) {
+        return atomic_fetch_add(uses, 1) + 1;
+    }
+    int current = atomic_load(uses);
+    while (current < limit) {
+        if (atomic_compare_exchange_weak(uses, &current, current + 1)) {
+            return current + 1;
+        }
     }
-    printf("Expected by: %s", ctime(&estimatedTime));
+    return 0;
 }
 
-/* =============================== FILE HANDLING =============================== */
-void saveUsersInorder(User *root, FILE *file) {
-    if (root != NULL) {
-        saveUsersInorder(root->left, file);
-        fprintf(file, "%s,%s,%s,%s,%d\n",
-                root->username, root->password, root->address,
-                root->phone, root->loyaltyPoints);
-        saveUsersInorder(root->right, file);
+/* Raises a counter to at least value; replay and saved counters may arrive in any order */
+static void raisePromoUse(_Atomic int *uses, int value) {
+    int current = atomic_load(uses);
+    while (current < value && !atomic_compare_exchange_weak(uses, &current, value)) {
     }
 }
 
-void saveData() {
+/* O(1) validation and redemption; an unusable code leaves the total unchanged */
+float redeemPromoCode(const char *code, const char *username, float total) {
+    /* Shared lock keeps insertPromoCode from redefining the code mid-check */
+    pthread_rwlock_rdlock(&promoTable.lock);
+    int slot = findPromoSlotLocked(code);
+    if (slot == -1) {
+        pthread_rwlock_unlock(&promoTable.lock);
+        notify("Invalid promo code!\n");
+        return total;
+    }
+    
+    PromoCode *promo = promoAt(slot);
+    time_t now = time(NULL);
+    if (promo->validFrom != 0 && now < promo->validFrom) {
+        pthread_rwlock_unlock(&promoTable.lock);
+        notify("✗ Promo code %s is not active yet.\n", code);
+        return total;
+    }
+    if (promo->validUntil != 0 && now >= promo->validUntil) {
+        pthread_rwlock_unlock(&promoTable.lock);
+        notify("✗ Promo code %s has expired.\n", code);
+        return total;
+    }
+    
+    _Atomic int *customerUses = NULL;
+    int customerCount = -1;
+    if (promo->maxUsesPerCustomer > 0) {
+        customerUses = redemptionCounter(slot, username);
+        customerCount = reservePromoUse(customerUses, promo->maxUsesPerCustomer);
+        if (customerCount == 0) {
+            pthread_rwlock_unlock(&promoTable.lock);
+            notify("✗ You have already used promo code %s.\n", code);
+            return total;
+        }
+    }
+    int totalCount = reservePromoUse(&promo->uses, promo->maxUses);
+    if (totalCount == 0) {
+        if (customerUses != NULL) atomic_fetch_sub(customerUses, 1);
+        pthread_rwlock_unlock(&promoTable.lock);
+        notify("✗ Promo code %s has been fully redeemed.\n", code);
+        return total;
+    }
+    float percent = promo->discount;
+    pthread_rwlock_unlock(&promoTable.lock);
+    
+    /* Journaled like the order, so a crash or an unsaved exit keeps the redemption */
+    journalRedemption(code, username, customerCount, totalCount);
+    
+    float discount = total * (percent / 100);
+    notify("✓ Applied promo code %s: %.0f%% discount (-$%.2f)\n", 
+           code, percent, discount);
+    return total - discount;
+}
+
+/* Lists the codes a customer could redeem right now */
+void displayPromoCodes() {
+    time_t now = time(NULL);
+    int shown = 0;
+    
+    printHeader("AVAILABLE PROMO CODES");
+    screenPrintf("Code\t\t\tDiscount\tExpires\t\tUses Left\n");
+    screenPrintf("────────────────────────────────────────────────────────────\n");
+    
+    pthread_rwlock_rdlock(&promoTable.lock);
+    for (int slot = 0; slot < promoTable.count; slot++) {
+        PromoCode *promo = promoAt(slot);
+        int uses = atomic_load(&promo->uses);
+        if ((promo->validFrom != 0 && now < promo->validFrom)
+            || (promo->validUntil != 0 && now >= promo->validUntil)
+            || (promo->maxUses > 0 && uses >= promo->maxUses)) {
+            continue;
+        }
+        
+        char expires[16] = "never";
+        if (promo->validUntil != 0) {
+            strftime(expires, sizeof(expires), "%Y-%m-%d", localtime(&promo->validUntil));
+        }
+        char left[16] = "unlimited";
+        if (promo->maxUses > 0) {
+            snprintf(left, sizeof(left), "%d", promo->maxUses - uses);
+        }
+        screenPrintf("%-20s\t%.0f%%%s\t\t%-10s\t%s\n", promo->code, promo->discount,
+                     promo->maxUsesPerCustomer > 0 ? "*" : "", expires, left);
+        shown++;
+    }
+    pthread_rwlock_unlock(&promoTable.lock);
+    
+    if (shown == 0) {
+        screenPrintf("No promo codes available!\n");
+    } else {
+        screenPrintf("\n* limited uses per customer\n");
+    }
+    screenFlush();
+}
+
+void releasePromoCodes() {
+    for (int b = 0; b < promoTable.blockCount; b++) {
+        free(promoTable.blocks[b]);
+    }
+    free(promoTable.slots);
+    promoTable.blockCount = promoTable.count = 0;
+    promoTable.slots = NULL;
+    promoTable.slotCapacity = 0;
+    
+    /* Redemption nodes go back with redemptionPool */
+    for (int i = 0; i < PROMO_REDEMPTION_STRIPES; i++) {
+        free(redemptionStripes[i].buckets);
+        redemptionStripes[i].buckets = NULL;
+        redemptionStripes[i].bucketCount = redemptionStripes[i].count = 0;
+    }
+}
+
+/* =============================== ORDER STORE =============================== */
+Order* orderAt(OrderHandle handle) {
+    return &orderStore.blocks[handle / ORDER_BLOCK_SIZE][handle % ORDER_BLOCK_SIZE];
+}
+
+OrderHandle findOrderHandle(int orderId) {
+    pthread_rwlock_rdlock(&orderStoreLock);
+    OrderHandle handle = idIndexGet(&orderStore.idIndex, orderId);
+    pthread_rwlock_unlock(&orderStoreLock);
+    return handle;
+}
+
+OrderHandle storeOrder(const Order *order) {
+    pthread_rwlock_wrlock(&orderStoreLock);
+    OrderHandle handle = orderStore.count;
+    
+    if (handle / ORDER_BLOCK_SIZE == orderStore.blockCount) {
+        if (orderStore.blockCount == ORDER_MAX_BLOCKS) {
+            fprintf(stderr, "Order store full\n");
+            exit(1);
+        }
+        orderStore.blocks[orderStore.blockCount++] = (Order*)xmalloc(sizeof(Order) * ORDER_BLOCK_SIZE);
+    }
+    
+    Order *stored = orderAt(handle);
+    *stored = *order;
+    stored->queueTicket = -1;
+    idIndexPut(&orderStore.idIndex, order->orderId, handle);
+    orderStore.count++;
+    pthread_rwlock_unlock(&orderStoreLock);
+    return handle;
+}
+
+/* =============================== CUSTOMER TABLE =============================== */
+static Account* accountAt(int accountId) {
+    return &customerTable.accountBlocks[accountId / CUSTOMER_BLOCK_SIZE][accountId % CUSTOMER_BLOCK_SIZE];
+}
+
+Customer* customerAt(int customerId) {
+    return &customerTable.customerBlocks[customerId / CUSTOMER_BLOCK_SIZE][customerId % CUSTOMER_BLOCK_SIZE];
+}
+
+const char* accountName(int accountId) {
+    return accountAt(accountId)->username;
+}
+
+const char* orderUsername(const Order *order) {
+    return accountName(customerAt(order->customerId)->accountId);
+}
+
+int orderAccountId(const Order *order) {
+    return customerAt(order->customerId)->accountId;
+}
+
+/* Keys stay non-negative so they never collide with ID_INDEX_EMPTY */
+static int customerKey(unsigned int hash) {
+    return (int)(hash & 0x7fffffff);
+}
+
+static int findAccountLocked(const char *username, int key) {
+    for (int id = idIndexGet(&customerTable.accountIndex, key); id != -1; id = accountAt(id)->nextInBucket) {
+        if (strcmp(accountAt(id)->username, username) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+int findAccount(const char *username) {
+    pthread_mutex_lock(&customerTable.lock);
+    int accountId = findAccountLocked(username, customerKey(hashString(username)));
+    pthread_mutex_unlock(&customerTable.lock);
+    return accountId;
+}
+
+/* Returns the id of the record for these details, creating it on first use */
+int internCustomer(const char *username, const char *address, const char *phone) {
+    pthread_mutex_lock(&customerTable.lock);
+    
+    int accountKey = customerKey(hashString(username));
+    int accountId = findAccountLocked(username, accountKey);
+    if (accountId == -1) {
+        accountId = customerTable.accountCount;
+        if (accountId % CUSTOMER_BLOCK_SIZE == 0) {
+            if (accountId / CUSTOMER_BLOCK_SIZE == CUSTOMER_MAX_BLOCKS) {
+                fprintf(stderr, "Customer table full\n");
+                exit(1);
+            }
+            customerTable.accountBlocks[accountId / CUSTOMER_BLOCK_SIZE] =
+                (Account*)xmalloc(sizeof(Account) * CUSTOMER_BLOCK_SIZE);
+        }
+        Account *account = accountAt(accountId);
+        strcpy(account->username, username);
+        account->orderIds = NULL;
+        account->orderCount = account->orderCapacity = 0;
+        account->nextInBucket = idIndexGet(&customerTable.accountIndex, accountKey);
+        idIndexPut(&customerTable.accountIndex, accountKey, accountId);
+        customerTable.accountCount++;
+    }
+    
+    int key = customerKey(hashInt(accountId) ^ hashString(address) ^ (hashString(phone) * 31u));
+    for (int id = idIndexGet(&customerTable.customerIndex, key); id != -1; id = customerAt(id)->nextInBucket) {
+        Customer *customer = customerAt(id);
+        if (customer->accountId == accountId && strcmp(customer->address, address) == 0 &&
+            strcmp(customer->phone, phone) == 0) {
+            pthread_mutex_unlock(&customerTable.lock);
+            return id;
+        }
+    }
+    
+    int customerId = customerTable.count;
+    if (customerId % CUSTOMER_BLOCK_SIZE == 0) {
+        if (customerId / CUSTOMER_BLOCK_SIZE == CUSTOMER_MAX_BLOCKS) {
+            fprintf(stderr, "Customer table full\n");
+            exit(1);
+        }
+        customerTable.customerBlocks[customerId / CUSTOMER_BLOCK_SIZE] =
+            (Customer*)xmalloc(sizeof(Customer) * CUSTOMER_BLOCK_SIZE);
+    }
+    Customer *customer = customerAt(customerId);
+    customer->accountId = accountId;
+    customer->zone = internDeliveryZone(address);
+    strcpy(customer->address, address);
+    strcpy(customer->phone, phone);
+    customer->nextInBucket = idIndexGet(&customerTable.customerIndex, key);
+    idIndexPut(&customerTable.customerIndex, key, customerId);
+    customerTable.count++;
+    
+    pthread_mutex_unlock(&customerTable.lock);
+    return customerId;
+}
+
+/* Secondary index: account -> order ids, appended at checkout */
+void indexAccountOrder(int accountId, int orderId) {
+    pthread_mutex_lock(&customerTable.lock);
+    Account *account = accountAt(accountId);
+    if (account->orderCount == account->orderCapacity) {
+        account->orderCapacity = account->orderCapacity ? account->orderCapacity * 2 : 8;
+        account->orderIds = (int*)xrealloc(account->orderIds, sizeof(int) * account->orderCapacity);
+    }
+    account->orderIds[account->orderCount++] = orderId;
+    pthread_mutex_unlock(&customerTable.lock);
+}
+
+int accountOrderCount(int accountId) {
+    if (accountId < 0) return 0;
+    
+    pthread_mutex_lock(&customerTable.lock);
+    int count = accountAt(accountId)->orderCount;
+    pthread_mutex_unlock(&customerTable.lock);
+    return count;
+}
+
+/* Newest first: skips the `skip` most recent, then copies up to k ids. O(k) */
+int recentAccountOrders(int accountId, int skip, int k, int *out) {
+    if (accountId < 0) return 0;
+    
+    pthread_mutex_lock(&customerTable.lock);
+    Account *account = accountAt(accountId);
+    if (skip < 0) skip = 0;
+    if (skip > account->orderCount) skip = account->orderCount;
+    int found = 0;
+    for (int i = account->orderCount - 1 - skip; i >= 0 && found < k; i--) {
+        out[found++] = account->orderIds[i];
+    }
+    pthread_mutex_unlock(&customerTable.lock);
+    return found;
+}
+
+void releaseCustomerTable() {
+    for (int id = 0; id < customerTable.accountCount; id++) {
+        free(accountAt(id)->orderIds);
+    }
+    for (int b = 0; b * CUSTOMER_BLOCK_SIZE < customerTable.accountCount; b++) {
+        free(customerTable.accountBlocks[b]);
+    }
+    for (int b = 0; b * CUSTOMER_BLOCK_SIZE < customerTable.count; b++) {
+        free(customerTable.customerBlocks[b]);
+    }
+    idIndexFree(&customerTable.accountIndex);
+    idIndexFree(&customerTable.customerIndex);
+    customerTable.accountCount = 0;
+    customerTable.count = 0;
+}
+
+/* =============================== ORDER MANAGEMENT =============================== */
+Order* createOrder(int customerId, int priority) {
+    Order newOrder;
+    
+    /* Ids and times are handed out together so orderTime never decreases with
+     * orderId, even across concurrent checkouts or a clock step backwards;
+     * history range queries binary-search times through the id order */
+    pthread_mutex_lock(&orderClockLock);
+    time_t now = time(NULL);
+    if (now < lastOrderTime) now = lastOrderTime;
+    lastOrderTime = now;
+    newOrder.orderId = currentOrderId++;
+    pthread_mutex_unlock(&orderClockLock);
+    
+    newOrder.customerId = customerId;
+    newOrder.lineOffset = 0;
+    newOrder.itemCount = 0;
+    newOrder.subtotal = 0;
+    newOrder.discount = 0;
+    newOrder.deliveryFee = 2.99;
+    newOrder.tax = 0;
+    newOrder.total = 0;
+    newOrder.priority = priority;
+    newOrder.status = 0; /* Pending */
+    newOrder.orderTime = now;
+    newOrder.statusTime = now;
+    
+    return orderAt(storeOrder(&newOrder));
+}
+
+OrderLine* orderLineAt(const Order *order, int index) {
+    unsigned int offset = order->lineOffset + (unsigned int)index;
+    return &lineArena.blocks[offset / LINE_BLOCK_LINES][offset % LINE_BLOCK_LINES];
+}
+
+/* Reserves count contiguous lines for an order that has none yet and returns
+ * them for the caller to fill. An order that does not fit the rest of the
+ * current block starts a fresh run; the skipped tail stays unused */
+OrderLine* allocOrderLines(Order *order, int count) {
+    pthread_mutex_lock(&lineArena.lock);
+    unsigned int end = (unsigned int)lineArena.blockCount * LINE_BLOCK_LINES;
+    unsigned int offset = lineArena.used;
+    if (offset + (unsigned int)count > end) {
+        int blocks = (count + LINE_BLOCK_LINES - 1) / LINE_BLOCK_LINES;
+        if (lineArena.blockCount + blocks > LINE_MAX_BLOCKS) {
+            fprintf(stderr, "Order line arena full\n");
+            exit(1);
+        }
+        OrderLine *run = (OrderLine*)xmalloc(sizeof(OrderLine) * LINE_BLOCK_LINES * blocks);
+        lineArena.owned[lineArena.blockCount] = 1;
+        for (int b = 0; b < blocks; b++) {
+            lineArena.blocks[lineArena.blockCount++] = run + (size_t)b * LINE_BLOCK_LINES;
+        }
+        offset = end;
+    }
+    lineArena.used = offset + (unsigned int)count;
+    pthread_mutex_unlock(&lineArena.lock);
+    
+    order->lineOffset = offset;
+    order->itemCount = count;
+    return orderLineAt(order, 0);
+}
+
+/* Copies every line into out (itemCount entries) in one memcpy */
+int copyOrderLines(const Order *order, OrderLine *out) {
+    if (order->itemCount > 0) {
+        memcpy(out, orderLineAt(order, 0), sizeof(OrderLine) * order->itemCount);
+    }
+    return order->itemCount;
+}
+
+void releaseOrderLines() {
+    for (int b = 0; b < lineArena.blockCount; b++) {
+        if (lineArena.owned[b]) free(lineArena.blocks[b]);
+        lineArena.owned[b] = 0;
+    }
+    lineArena.blockCount = 0;
+    lineArena.used = 0;
+}
+
+void displayOrderDetails(Order *order) {
+    screenPrintf("\n════════════════════════════════════════════════════════════\n");
+    screenPrintf("                    ORDER DETAILS\n");
+    screenPrintf("════════════════════════════════════════════════════════════\n");
+    screenPrintf("Order ID: #%d\n", order->orderId);
+    Customer *customer = customerAt(order->customerId);
+    screenPrintf("Customer: %s\n", accountName(customer->accountId));
+    screenPrintf("Address: %s\n", customer->address);
+    screenPrintf("Phone: %s\n", customer->phone);
+    screenPrintf("Order Time: %s", formatTimestamp(order->orderTime));
+    screenPrintf("Status: %s (Updated: %s)", getStatusText(order->status), formatTimestamp(order->statusTime));
+    screenPrintf("Priority: %s\n", getPriorityText(order->priority));
+    screenPrintf("\n────────────────────────────────────────────────────────────\n");
+    screenPrintf("ORDER ITEMS:\n");
+    screenPrintf("────────────────────────────────────────────────────────────\n");
+    
+    if (order->itemCount == 0) {
+        screenPrintf("No items in order.\n");
+    } else {
+        screenPrintf("No.\tItem\t\t\tQty\tPrice\tSubtotal\n");
+        screenPrintf("────────────────────────────────────────────────────────────\n");
+        
+        for (int i = 0; i < order->itemCount; i++) {
+            OrderLine *line = orderLineAt(order, i);
+            FoodItem *item = findMenuItem(line->itemId);
+            char fallback[24];
+            snprintf(fallback, sizeof(fallback), "Item #%d", line->itemId);
+            float subtotal = line->price * line->quantity;
+            screenPrintf("%d.\t%-20s\t%d\t$%.2f\t$%.2f\n", 
+                         i + 1, item != NULL ? menuItemName(item) : fallback,
+                         line->quantity, line->price, subtotal);
+        }
+    }
+    
+    screenPrintf("\n────────────────────────────────────────────────────────────\n");
+    screenPrintf("ORDER SUMMARY:\n");
+    screenPrintf("────────────────────────────────────────────────────────────\n");
+    screenPrintf("Subtotal: $%.2f\n", order->subtotal);
+    screenPrintf("Discount: -$%.2f\n", order->discount);
+    screenPrintf("Delivery Fee: $%.2f\n", order->deliveryFee);
+    screenPrintf("Tax (8%%): $%.2f\n", order->tax);
+    screenPrintf("────────────────────────────────────────────────────────────\n");
+    screenPrintf("TOTAL: $%.2f\n", order->total);
+    screenPrintf("════════════════════════════════════════════════════════════\n");
+    screenFlush();
+}
+
+static void initOrderStatusLocks(void) {
+    for (int i = 0; i < ORDER_STATUS_STRIPES; i++) {
+        pthread_mutex_init(&orderStatusLocks[i], NULL);
+    }
+}
+
+static pthread_mutex_t* orderStatusLock(const Order *order) {
+    static pthread_once_t locksReady = PTHREAD_ONCE_INIT;
+    pthread_once(&locksReady, initOrderStatusLocks);
+    return &orderStatusLocks[(unsigned int)order->orderId % ORDER_STATUS_STRIPES];
+}
+
+/* Caller holds the order's status lock */
+static void setOrderStatusLocked(Order *order, int newStatus) {
+    time_t now = time(NULL);
+    etaRecordStatus(order->status, order->statusTime, newStatus, now);
+    order->status = newStatus;
+    order->statusTime = now;
+    journalEvent(JOURNAL_STATUS, order);
+}
+
+void updateOrderStatus(Order *order, int newStatus) {
+    pthread_mutex_lock(orderStatusLock(order));
+    setOrderStatusLocked(order, newStatus);
+    pthread_mutex_unlock(orderStatusLock(order));
+    compactOrderJournalIfDue();
+}
+
+/* Check-and-set: moves the order on only if nobody changed it since it was read.
+ * Returns 0 when the status is no longer expected */
+int advanceOrderStatus(Order *order, int expected, int newStatus) {
+    pthread_mutex_lock(orderStatusLock(order));
+    int advanced = order->status == expected;
+    if (advanced) {
+        setOrderStatusLocked(order, newStatus);
+    }
+    pthread_mutex_unlock(orderStatusLock(order));
+    
+    if (advanced) compactOrderJournalIfDue();
+    return advanced;
+}
+
+/* =============================== STACK - ORDER PROCESSING =============================== */
+/* Caller holds orderStackLock */
+static void stackUnlinkLocked(OrderStack *node) {
+    if (node->above != NULL) node->above->next = node->next;
+    else orderStackTop = node->next;
+    if (node->next != NULL) node->next->above = node->above;
+    else orderStackBottom = node->above;
+}
+
+void stackPushHandle(OrderHandle handle, int journal) {
+    OrderStack *newOrder = (OrderStack*)slabAlloc(&orderStackPool);
+    newOrder->handle = handle;
+    
+    pthread_mutex_lock(&orderStackLock);
+    newOrder->next = orderStackTop;
+    newOrder->above = NULL;
+    if (orderStackTop != NULL) orderStackTop->above = newOrder;
+    else orderStackBottom = newOrder;
+    orderStackTop = newOrder;
+    if (journal) {
+        journalEvent(JOURNAL_PUSH, orderAt(handle));  /* Same order as the stack sees it */
+    }
+    pthread_mutex_unlock(&orderStackLock);
+}
+
+OrderHandle stackPopHandle(int journal) {
+    pthread_mutex_lock(&orderStackLock);
+    if (orderStackTop == NULL) {
+        pthread_mutex_unlock(&orderStackLock);
+        return -1;
+    }
+    
+    OrderStack *temp = orderStackTop;
+    OrderHandle handle = temp->handle;
+    stackUnlinkLocked(temp);
+    if (journal) {
+        journalEvent(JOURNAL_POP, orderAt(handle));
+    }
+    pthread_mutex_unlock(&orderStackLock);
+    
+    slabFree(&orderStackPool, temp);
+    return handle;
+}
+
+/* Takes the bottom order if it has been pending since placedBefore; -1 otherwise.
+ * The journal's pop names the order, so replay removes this one and not the top */
+OrderHandle stackTakeOldest(time_t placedBefore, int journal) {
+    pthread_mutex_lock(&orderStackLock);
+    OrderStack *oldest = orderStackBottom;
+    if (oldest == NULL || orderAt(oldest->handle)->statusTime > placedBefore) {
+        pthread_mutex_unlock(&orderStackLock);
+        return -1;
+    }
+    
+    OrderHandle handle = oldest->handle;
+    stackUnlinkLocked(oldest);
+    if (journal) {
+        journalEvent(JOURNAL_POP, orderAt(handle));
+    }
+    pthread_mutex_unlock(&orderStackLock);
+    
+    slabFree(&orderStackPool, oldest);
+    return handle;
+}
+
+/* Replay: pops name their order; the top matches unless the pipeline took the bottom */
+void stackRemoveHandle(OrderHandle handle) {
+    pthread_mutex_lock(&orderStackLock);
+    OrderStack *node = orderStackTop;
+    if (node != NULL && node->handle != handle) {
+        node = orderStackBottom;
+        while (node != NULL && node->handle != handle) node = node->above;
+    }
+    if (node != NULL) stackUnlinkLocked(node);
+    pthread_mutex_unlock(&orderStackLock);
+    
+    if (node != NULL) slabFree(&orderStackPool, node);
+}
+
+void pushOrder(OrderHandle handle) {
+    stackPushHandle(handle, 1);
+    
+    notify("✓ Order #%d placed successfully!\n", orderAt(handle)->orderId);
+}
+
+Order* popOrder() {
+    OrderHandle handle = stackPopHandle(1);
+    if (handle == -1) {
+        notify("No orders to process!\n");
+        return NULL;
+    }
+    
+    compactOrderJournalIfDue();
+    return orderAt(handle);
+}
+
+void displayOrderStack() {
+    if (orderStackTop == NULL) {
+        screenPrintf("No pending orders!\n");
+        screenFlush();
+        return;
+    }
+    
+    printHeader("PENDING ORDERS (STACK)");
+    screenPrintf("Order ID\tCustomer\t\tStatus\t\t\tTotal\tTime\n");
+    screenPrintf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
+    
+    OrderStack *current = orderStackTop;
+    while (current != NULL) {
+        Order *order = orderAt(current->handle);
+        screenPrintf("#%d\t\t%-15s\t%-20s\t$%.2f\t%s", 
+                     order->orderId, orderUsername(order), 
+                     getStatusText(order->status), order->total, 
+                     formatTimestamp(order->orderTime));
+        current = current->next;
+    }
+    screenFlush();
+}
+
+/* =============================== BUCKETED PRIORITY QUEUE - DELIVERY SYSTEM =============================== */
+int priorityBucket(int priority) {
+    if (priority < 1) return 0;
+    if (priority > PRIORITY_LEVELS) return PRIORITY_LEVELS - 1;
+    return priority - 1;
+}
+
+/* "12B Baker Street, Flat 3" -> "baker street": the part before the first
+ * comma, lower-cased, with house numbers and other digit words dropped */
+void deliveryStreet(const char *address, char *street, size_t size) {
+    size_t length = 0;
+    const char *p = address;
+    
+    while (*p != '\0' && *p != ',') {
+        while (*p == ' ' || *p == '\t') p++;
+        const char *word = p;
+        int hasDigit = 0;
+        while (*p != '\0' && *p != ',' && *p != ' ' && *p != '\t') {
+            if (isdigit((unsigned char)*p)) hasDigit = 1;
+            p++;
+        }
+        if (hasDigit || p == word || *word == '#') continue;
+        
+        if (length > 0 && length + 1 < size) street[length++] = ' ';
+        for (; word < p && length + 1 < size; word++) {
+            street[length++] = (char)tolower((unsigned char)*word);
+        }
+    }
+    street[length] = '\0';
+    if (length == 0) {
+        snprintf(street, size, "unknown");
+    }
+}
+
+static DeliveryZone* zoneAt(int zone) {
+    return &zoneTable.blocks[zone / ZONE_BLOCK_SIZE][zone % ZONE_BLOCK_SIZE];
+}
+
+/* Returns the zone of this address's street, creating it on first use */
+int internDeliveryZone(const char *address) {
+    char street[MAX_ADDR];
+    deliveryStreet(address, street, sizeof(street));
+    int key = (int)(hashString(street) & 0x7fffffff);
+    
+    pthread_mutex_lock(&zoneTable.lock);
+    for (int id = idIndexGet(&zoneTable.index, key); id != -1; id = zoneAt(id)->nextInBucket) {
+        if (strcmp(zoneAt(id)->street, street) == 0) {
+            pthread_mutex_unlock(&zoneTable.lock);
+            return id;
+        }
+    }
+    
+    int zone = zoneTable.count;
+    if (zone % ZONE_BLOCK_SIZE == 0) {
+        if (zone / ZONE_BLOCK_SIZE == ZONE_MAX_BLOCKS) {
+            fprintf(stderr, "Zone table full\n");
+            exit(1);
+        }
+        zoneTable.blocks[zone / ZONE_BLOCK_SIZE] = (DeliveryZone*)xcalloc(ZONE_BLOCK_SIZE, sizeof(DeliveryZone));
+    }
+    DeliveryZone *entry = zoneAt(zone);
+    strcpy(entry->street, street);
+    entry->nextInBucket = idIndexGet(&zoneTable.index, key);
+    idIndexPut(&zoneTable.index, key, zone);
+    zoneTable.count++;
+    
+    pthread_mutex_unlock(&zoneTable.lock);
+    return zone;
+}
+
+const char* deliveryZoneName(int zone) {
+    return zoneAt(zone)->street;
+}
+
+void releaseDeliveryZones() {
+    for (int b = 0; b * ZONE_BLOCK_SIZE < zoneTable.count; b++) {
+        free(zoneTable.blocks[b]);
+    }
+    idIndexFree(&zoneTable.index);
+    zoneTable.count = 0;
+}
+
+/* Both links are O(1); the caller holds the lock of bucket b */
+static void deliveryLink(Delivery *node, int b) {
+    DeliveryBucket *bucket = &deliveryBuckets[b];
+    DeliveryZone *zone = zoneAt(node->zone);
+    
+    node->next = NULL;
+    node->prev = bucket->rear;
+    if (bucket->rear == NULL) {
+        bucket->front = node;
+    } else {
+        bucket->rear->next = node;
+    }
+    bucket->rear = node;
+    
+    node->zoneNext = NULL;
+    node->zonePrev = zone->rear[b];
+    if (zone->rear[b] == NULL) {
+        zone->front[b] = node;
+    } else {
+        zone->rear[b]->zoneNext = node;
+    }
+    zone->rear[b] = node;
+    
+    if (bucket->tickets == bucket->capacity) {
+        /* Doubling keeps every old node; only the new root covers the old range */
+        int capacity = bucket->capacity ? bucket->capacity * 2 : 64;
+        int *departed = (int*)xcalloc(capacity + 1, sizeof(int));
+        if (bucket->capacity > 0) {
+            memcpy(departed, bucket->departed, sizeof(int) * (bucket->capacity + 1));
+            departed[capacity] = bucket->departed[bucket->capacity];
+        }
+        free(bucket->departed);
+        bucket->departed = departed;
+        bucket->capacity = capacity;
+    }
+    
+    orderAt(node->handle)->queueTicket = bucket->tickets++;
+    bucket->depth++;
+    deliveryCount++;
+}
+
+static void deliveryUnlink(Delivery *node, int b) {
+    DeliveryBucket *bucket = &deliveryBuckets[b];
+    DeliveryZone *zone = zoneAt(node->zone);
+    
+    if (node->prev != NULL) node->prev->next = node->next;
+    else bucket->front = node->next;
+    if (node->next != NULL) node->next->prev = node->prev;
+    else bucket->rear = node->prev;
+    
+    if (node->zonePrev != NULL) node->zonePrev->zoneNext = node->zoneNext;
+    else zone->front[b] = node->zoneNext;
+    if (node->zoneNext != NULL) node->zoneNext->zonePrev = node->zonePrev;
+    else zone->rear[b] = node->zonePrev;
+    
+    int ticket = orderAt(node->handle)->queueTicket;
+    orderAt(node->handle)->queueTicket = -1;
+    bucket->depth--;
+    deliveryCount--;
+    
+    if (bucket->depth == 0) {
+        /* No live tickets: clear the used nodes and the path above them, then restart */
+        memset(bucket->departed + 1, 0, sizeof(int) * bucket->tickets);
+        for (int i = bucket->tickets; i <= bucket->capacity; i += i & -i) {
+            bucket->departed[i] = 0;
+        }
+        bucket->tickets = 0;
+    } else {
+        for (int i = ticket + 1; i <= bucket->capacity; i += i & -i) {
+            bucket->departed[i]++;
+        }
+    }
+}
+
+void deliveryAppend(OrderHandle handle, int journal) {
+    Delivery *newDelivery = (Delivery*)slabAlloc(&deliveryPool);
+    newDelivery->handle = handle;
+    newDelivery->zone = customerAt(orderAt(handle)->customerId)->zone;
+    
+    /* O(1) append to the FIFO of this priority and to its zone's FIFO */
+    int b = priorityBucket(orderAt(handle)->priority);
+    pthread_mutex_lock(&deliveryBuckets[b].lock);
+    deliveryLink(newDelivery, b);
+    if (journal) {
+        journalEvent(JOURNAL_ENQUEUE, orderAt(handle));
+    }
+    pthread_mutex_unlock(&deliveryBuckets[b].lock);
+}
+
+OrderHandle deliveryPopFront(int journal) {
+    /* Highest priority first, FIFO within a priority */
+    for (int b = PRIORITY_LEVELS - 1; b >= 0; b--) {
+        DeliveryBucket *bucket = &deliveryBuckets[b];
+        pthread_mutex_lock(&bucket->lock);
+        if (bucket->front == NULL) {
+            pthread_mutex_unlock(&bucket->lock);
+            continue;
+        }
+        
+        Delivery *temp = bucket->front;
+        OrderHandle handle = temp->handle;
+        deliveryUnlink(temp, b);
+        if (journal) {
+            journalEvent(JOURNAL_DEQUEUE, orderAt(handle));
+        }
+        pthread_mutex_unlock(&bucket->lock);
+        
+        slabFree(&deliveryPool, temp);
+        return handle;
+    }
+    return -1;
+}
+
+/* Takes one specific order off the queue, wherever it sits. Only its
+ * zone's FIFO of its priority is walked, from both ends at once: replayed
+ * dispatches sit near the front, orders the kitchen pipeline takes from
+ * the stack near the back. Returns 0 if it was not queued */
+int deliveryRemove(OrderHandle handle, int journal) {
+    Order *order = orderAt(handle);
+    int b = priorityBucket(order->priority);
+    DeliveryZone *zone = zoneAt(customerAt(order->customerId)->zone);
+    
+    pthread_mutex_lock(&deliveryBuckets[b].lock);
+    Delivery *node = NULL;
+    Delivery *head = zone->front[b], *tail = zone->rear[b];
+    while (head != NULL && node == NULL) {
+        if (head->handle == handle) node = head;
+        else if (tail->handle == handle) node = tail;
+        else if (head == tail || head->zoneNext == tail) break;
+        head = head->zoneNext;
+        tail = tail->zonePrev;
+    }
+    if (node != NULL) {
+        deliveryUnlink(node, b);
+        if (journal) {
+            journalEvent(JOURNAL_DEQUEUE, order);
+        }
+    }
+    pthread_mutex_unlock(&deliveryBuckets[b].lock);
+    
+    if (node == NULL) return 0;
+    slabFree(&deliveryPool, node);
+    return 1;
+}
+
+/* Fills one driver trip with up to maxOrders orders, returned in out.
+ * The trip is anchored on the next order by priority, unless some order
+ * has already waited maxWaitSeconds, in which case the longest waiting
+ * one goes first. The rest of the trip comes from the anchor's zone,
+ * highest priority then oldest first. O(maxOrders + PRIORITY_LEVELS) */
+int deliveryTakeBatch(int maxOrders, int maxWaitSeconds, time_t now, OrderHandle *out, int journal) {
+    Delivery *taken[DISPATCH_BATCH_MAX];
+    if (maxOrders > DISPATCH_BATCH_MAX) maxOrders = DISPATCH_BATCH_MAX;
+    if (maxOrders < 1) return 0;
+    
+    /* Same order as compaction, so the two never deadlock */
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        pthread_mutex_lock(&deliveryBuckets[b].lock);
+    }
+    
+    /* Each bucket is FIFO, so its front is its longest waiting order */
+    Delivery *anchor = NULL;
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        Delivery *front = deliveryBuckets[b].front;
+        if (front == NULL || now - orderAt(front->handle)->orderTime < maxWaitSeconds) continue;
+        if (anchor == NULL || orderAt(front->handle)->orderTime < orderAt(anchor->handle)->orderTime) {
+            anchor = front;
+        }
+    }
+    for (int b = PRIORITY_LEVELS - 1; b >= 0 && anchor == NULL; b--) {
+        anchor = deliveryBuckets[b].front;
+    }
+    
+    int count = 0;
+    if (anchor != NULL) {
+        DeliveryZone *zone = zoneAt(anchor->zone);
+        deliveryUnlink(anchor, priorityBucket(orderAt(anchor->handle)->priority));
+        taken[count++] = anchor;
+        
+        for (int b = PRIORITY_LEVELS - 1; b >= 0 && count < maxOrders; b--) {
+            while (zone->front[b] != NULL && count < maxOrders) {
+                Delivery *node = zone->front[b];
+                deliveryUnlink(node, b);
+                taken[count++] = node;
+            }
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        out[i] = taken[i]->handle;
+        if (journal) {
+            journalEvent(JOURNAL_DEQUEUE, orderAt(out[i]));
+        }
+    }
+    for (int b = PRIORITY_LEVELS - 1; b >= 0; b--) {
+        pthread_mutex_unlock(&deliveryBuckets[b].lock);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        slabFree(&deliveryPool, taken[i]);
+    }
+    return count;
+}
+
+void enqueueDelivery(OrderHandle handle) {
+    deliveryAppend(handle, 1);
+    etaRecordEnqueue(time(NULL));
+    
+    notify("✓ Delivery queued for Order #%d\n", orderAt(handle)->orderId);
+}
+
+Order* dequeueDelivery() {
+    OrderHandle handle = deliveryPopFront(1);
+    if (handle == -1) {
+        notify("No deliveries pending!\n");
+        return NULL;
+    }
+    
+    etaRecordDispatch(1, time(NULL));
+    compactOrderJournalIfDue();
+    return orderAt(handle);
+}
+
+int dispatchBatch(int maxOrders, int maxWaitSeconds, OrderHandle *out) {
+    time_t now = time(NULL);
+    int count = deliveryTakeBatch(maxOrders, maxWaitSeconds, now, out, 1);
+    if (count == 0) {
+        notify("No deliveries pending!\n");
+        return 0;
+    }
+    
+    etaRecordDispatch(count, now);
+    compactOrderJournalIfDue();
+    return count;
+}
+
+void displayDispatchBatch(const OrderHandle *handles, int count) {
+    printHeader("DRIVER TRIP");
+    screenPrintf("Zone: %s, %d order(s)\n\n", deliveryZoneName(customerAt(orderAt(handles[0])->customerId)->zone), count);
+    screenPrintf("Stop\tOrder ID\tCustomer\t\tPriority\tWaited\t\tAddress\n");
+    screenPrintf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
+    
+    time_t now = time(NULL);
+    for (int i = 0; i < count; i++) {
+        Order *order = orderAt(handles[i]);
+        screenPrintf("%d\t#%d\t\t%-15s\t%s\t%ld min\t\t%s\n",
+                     i + 1, order->orderId, orderUsername(order), getPriorityText(order->priority),
+                     (long)(now - order->orderTime) / 60, customerAt(order->customerId)->address);
+    }
+    screenFlush();
+}
+
+int deliveryQueueDepth(int priority) {
+    return deliveryBuckets[priorityBucket(priority)].depth;
+}
+
+int deliveryQueueSize() {
+    return deliveryCount;
+}
+
+void displayDeliveryQueue() {
+    if (deliveryCount == 0) {
+        screenPrintf("No deliveries in queue!\n");
+        screenFlush();
+        return;
+    }
+    
+    printHeader("DELIVERY QUEUE");
+    screenPrintf("Queued: %d (Express %d, High %d, Normal %d, Low %d)\n",
+                 deliveryCount, deliveryQueueDepth(4), deliveryQueueDepth(3),
+                 deliveryQueueDepth(2), deliveryQueueDepth(1));
+    pthread_mutex_lock(&etaEngine.lock);
+    screenPrintf("Dispatching one order every %.1f min, kitchen %.0f min, drive %.0f min\n\n",
+                 etaEngine.dispatchSeconds / 60,
+                 (etaEngine.stageSeconds[0] + etaEngine.stageSeconds[1] + etaEngine.stageSeconds[2]) / 60,
+                 etaEngine.stageSeconds[3] / 60);
+    pthread_mutex_unlock(&etaEngine.lock);
+    screenPrintf("Position\tOrder ID\tCustomer\t\tStatus\t\t\tPriority\tZone\n");
+    screenPrintf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
+    
+    int position = 1;
+    for (int b = PRIORITY_LEVELS - 1; b >= 0; b--) {
+        Delivery *current = deliveryBuckets[b].front;
+        while (current != NULL) {
+            Order *order = orderAt(current->handle);
+            screenPrintf("%d\t\t#%d\t\t%-15s\t%-20s\t%s\t%s\n", 
+                         position++, order->orderId, orderUsername(order),
+                         getStatusText(order->status), getPriorityText(order->priority),
+                         deliveryZoneName(current->zone));
+            current = current->next;
+        }
+    }
+    screenFlush();
+}
+
+/* =============================== ETA ENGINE =============================== */
+static void etaBlend(double *average, double sample) {
+    *average += ETA_SMOOTHING * (sample - *average);
+}
+
+/* Only single-step moves are timed; a skipped stage has no clean sample */
+void etaRecordStatus(int oldStatus, time_t oldStatusTime, int newStatus, time_t now) {
+    if (newStatus != oldStatus + 1 || oldStatus < 0 || oldStatus >= ETA_STAGES) return;
+    long elapsed = (long)(now - oldStatusTime);
+    if (elapsed < 0 || elapsed > ETA_MAX_SAMPLE) return;
+    
+    pthread_mutex_lock(&etaEngine.lock);
+    etaBlend(&etaEngine.stageSeconds[oldStatus], (double)elapsed);
+    etaEngine.samples[oldStatus]++;
+    pthread_mutex_unlock(&etaEngine.lock);
+}
+
+/* The dispatch clock only runs while something is waiting */
+void etaRecordEnqueue(time_t now) {
+    pthread_mutex_lock(&etaEngine.lock);
+    if (etaEngine.busySince == 0) {
+        etaEngine.busySince = now;
+    }
+    pthread_mutex_unlock(&etaEngine.lock);
+}
+
+void etaRecordDispatch(int count, time_t now) {
+    pthread_mutex_lock(&etaEngine.lock);
+    long elapsed = (long)(now - etaEngine.busySince);
+    if (etaEngine.busySince != 0 && count > 0 && elapsed >= 0 && elapsed <= ETA_MAX_SAMPLE) {
+        etaBlend(&etaEngine.dispatchSeconds, (double)elapsed / count);
+        etaEngine.samples[ETA_STAGES]++;
+    }
+    etaEngine.busySince = deliveryCount > 0 ? now : 0;
+    pthread_mutex_unlock(&etaEngine.lock);
+}
+
+/* Orders that leave the queue before this one: everything queued at a
+ * higher priority, plus the lower tickets still in its own FIFO. Batches
+ * serve later tickets early, so only departures below this ticket count. O(log n) */
+int deliveryOrdersAhead(const Order *order) {
+    int b = priorityBucket(order->priority);
+    DeliveryBucket *bucket = &deliveryBuckets[b];
+    
+    pthread_mutex_lock(&bucket->lock);
+    int ticket = order->queueTicket;
+    int ahead = ticket;
+    for (int i = ticket; i > 0; i -= i & -i) {
+        ahead -= bucket->departed[i];
+    }
+    pthread_mutex_unlock(&bucket->lock);
+    if (ticket < 0) return -1;
+    
+    for (int higher = b + 1; higher < PRIORITY_LEVELS; higher++) {
+        ahead += deliveryBuckets[higher].depth;
+    }
+    return ahead;
+}
+
+/* Expected delivery time, 0 for a cancelled order. The kitchen and the
+ * delivery queue run side by side, so the order leaves when the later of
+ * the two is done, then spends the average drive on the road. O(log n),
+ * from the Fenwick count of orders ahead in the delivery queue */
+time_t estimateDelivery(const Order *order, int *ahead) {
+    time_t now = time(NULL);
+    *ahead = deliveryOrdersAhead(order);
+    if (order->status == 4) return order->statusTime;
+    if (order->status == 5) return 0;
+    
+    pthread_mutex_lock(&etaEngine.lock);
+    double stages[ETA_STAGES];
+    memcpy(stages, etaEngine.stageSeconds, sizeof(stages));
+    double dispatchSeconds = etaEngine.dispatchSeconds;
+    pthread_mutex_unlock(&etaEngine.lock);
+    
+    double elapsed = (double)(now - order->statusTime);
+    if (order->status == 3) {
+        double left = stages[3] - elapsed;
+        return now + (time_t)(left > 0 ? left : 0);
+    }
+    
+    /* Kitchen stages still to go, less the time the current one has taken */
+    double kitchen = -elapsed;
+    for (int s = order->status < 0 ? 0 : order->status; s < 3; s++) {
+        kitchen += stages[s];
+    }
+    if (kitchen < 0) kitchen = 0;
+    double queue = *ahead >= 0 ? (*ahead + 1) * dispatchSeconds : 0;
+    
+    return now + (time_t)((kitchen > queue ? kitchen : queue) + stages[3]);
+}
+
+void resetEtaEngine() {
+    pthread_mutex_lock(&etaEngine.lock);
+    memcpy(etaEngine.stageSeconds, etaSeedSeconds, sizeof(etaEngine.stageSeconds));
+    etaEngine.dispatchSeconds = etaSeedSeconds[ETA_STAGES];
+    etaEngine.busySince = 0;
+    memset(etaEngine.samples, 0, sizeof(etaEngine.samples));
+    pthread_mutex_unlock(&etaEngine.lock);
+}
+
+/* =============================== KITCHEN PIPELINE =============================== */
+void pauseMicros(int micros) {
+#ifdef _WIN32
+    Sleep((DWORD)((micros + 999) / 1000));
+#else
+    struct timespec ts = { micros / 1000000, (long)(micros % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void pipelineRingInit(PipelineRing *ring, size_t capacity) {
+    ring->cells = (PipelineCell*)xmalloc(sizeof(PipelineCell) * capacity);
+    ring->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_store_explicit(&ring->cells[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store(&ring->enqueuePos, 0);
+    atomic_store(&ring->dequeuePos, 0);
+}
+
+/* Returns 0 when the ring is full. Lock-free: a producer only retries
+ * after another producer has claimed the same cell */
+int pipelineRingPush(PipelineRing *ring, OrderHandle handle, double readyAt) {
+    size_t pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+    for (;;) {
+        PipelineCell *cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        long diff = (long)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->handle = handle;
+                cell->readyAt = readyAt;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;   /* The consumer has not freed this cell yet */
+        } else {
+            pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+/* Returns 0 when the ring is empty */
+int pipelineRingPop(PipelineRing *ring, OrderHandle *handle, double *readyAt) {
+    size_t pos = atomic_load_explicit(&ring->dequeuePos, memory_order_relaxed);
+    for (;;) {
+        PipelineCell *cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        long diff = (long)(sequence - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *handle = cell->handle;
+                *readyAt = cell->readyAt;
+                atomic_store_explicit(&cell->sequence, pos + ring->mask + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&ring->dequeuePos, memory_order_relaxed);
+        }
+    }
+}
+
+static size_t pipelineRingDepth(PipelineRing *ring) {
+    return atomic_load(&ring->enqueuePos) - atomic_load(&ring->dequeuePos);
+}
+
+static void pipelineRecordMax(_Atomic long long *max, long long value) {
+    long long seen = atomic_load_explicit(max, memory_order_relaxed);
+    while (value > seen && !atomic_compare_exchange_weak(max, &seen, value)) {
+    }
+}
+
+/* Releases the order a worker held; the move count goes up first */
+static void pipelineRelease(int moved) {
+    if (moved) atomic_fetch_add(&kitchenPipeline.moves, 1);
+    atomic_fetch_sub(&kitchenPipeline.active, 1);
+}
+
+/* Stage s moves an order from status s to s + 1 with a check-and-set, so a
+ * status set by hand in the meantime is never overwritten: an order already
+ * moved on is passed along, a cancelled or moved-back one leaves the pipeline. */
+void* pipelineWorker(void *arg) {
+    PipelineStage *stage = (PipelineStage*)arg;
+    int s = (int)(stage - kitchenPipeline.stages);
+    PipelineStage *next = s + 1 < PIPELINE_STAGES ? stage + 1 : NULL;
+    OrderHandle held = -1;              /* Not due yet and no room to requeue it */
+    double heldReadyAt = 0;
+    
+    for (;;) {
+        OrderHandle handle;
+        double readyAt;
+        int done = atomic_load(&stage->upstreamDone);
+        
+        if (held != -1) {
+            handle = held;
+            readyAt = heldReadyAt;
+            held = -1;
+        } else {
+            /* Counted before taking, so pipelineIdle() never misses an order in hand */
+            atomic_fetch_add(&kitchenPipeline.active, 1);
+            if (s == 0) {
+                /* Oldest first; stopping leaves the rest on the stack */
+                handle = done ? -1 : stackTakeOldest(time(NULL) - stage->handoffSeconds, 1);
+                readyAt = benchNow();
+            } else if (!pipelineRingPop(&stage->input, &handle, &readyAt)) {
+                handle = -1;
+            }
+            if (handle == -1) {
+                pipelineRelease(0);
+                if (done) break;
+                pauseMicros(PIPELINE_IDLE_MICROS);
+                continue;
+            }
+        }
+        
+        Order *order = orderAt(handle);
+        int status = order->status;
+        if (status == s) {
+            int due = stage->handoffSeconds != PIPELINE_BY_HAND &&
+                      time(NULL) - order->statusTime >= stage->handoffSeconds;
+            if (!due) {
+                /* Waits at the back of its own ring; once stopping it stays where it is */
+                if (!done && s > 0 && !pipelineRingPush(&stage->input, handle, readyAt)) {
+                    held = handle;
+                    heldReadyAt = readyAt;
+                } else {
+                    pipelineRelease(!done && s > 0);
+                }
+                pauseMicros(PIPELINE_IDLE_MICROS);
+                continue;
+            }
+            if (stage->workMicros > 0) {
+                pauseMicros(stage->workMicros);
+            }
+            if (!advanceOrderStatus(order, s, s + 1)) {
+                status = order->status;     /* Changed by hand meanwhile */
+            } else {
+                status = s + 1;
+            }
+        }
+        if (status == 5 || status < s) {
+            /* Cancelled or taken back by hand: leaves without touching the queue */
+            pipelineRelease(0);
+            continue;
+        }
+        if (s == 2 && deliveryRemove(handle, 1)) {
+            etaRecordDispatch(1, time(NULL));   /* Picked up by a driver */
+        }
+        
+        double finished = benchNow();
+        long long latency = (long long)((finished - readyAt) * 1e6);
+        atomic_fetch_add(&stage->processed, 1);
+        atomic_fetch_add(&stage->latencyMicros, latency);
+        pipelineRecordMax(&stage->maxLatencyMicros, latency);
+        
+        if (next != NULL && !pipelineRingPush(&next->input, handle, finished)) {
+            /* Backpressure: hold the order until the next stage makes room */
+            atomic_fetch_add(&stage->stalls, 1);
+            while (!pipelineRingPush(&next->input, handle, benchNow())) {
+                pauseMicros(PIPELINE_IDLE_MICROS);
+            }
+            atomic_fetch_add(&stage->stallMicros, (long long)((benchNow() - finished) * 1e6));
+        }
+        pipelineRelease(next != NULL);
+    }
+    return NULL;
+}
+
+/* handoffSeconds NULL: every stage hands on at once; workMicros NULL: no
+ * simulated work, which only the benchmark adds. Returns 0 if the pipeline
+ * is already running, -1 if a stage got no worker thread */
+int startKitchenPipeline(const int workers[], const int handoffSeconds[], const int workMicros[]) {
+    pthread_mutex_lock(&kitchenPipeline.lock);
+    if (kitchenPipeline.running) {
+        pthread_mutex_unlock(&kitchenPipeline.lock);
+        return 0;
+    }
+    
+    for (int s = 0; s < PIPELINE_STAGES; s++) {
+        PipelineStage *stage = &kitchenPipeline.stages[s];
+        stage->name = pipelineStageNames[s];
+        stage->workers = workers[s] < 1 ? 1 : workers[s] > PIPELINE_MAX_WORKERS ? PIPELINE_MAX_WORKERS : workers[s];
+        stage->handoffSeconds = handoffSeconds != NULL ? handoffSeconds[s] : 0;
+        if (stage->handoffSeconds < 0) {
+            /* Taking an order off the stack is the confirmation, so the first stage never waits by hand */
+            stage->handoffSeconds = s == 0 ? 0 : PIPELINE_BY_HAND;
+        }
+        stage->workMicros = workMicros != NULL ? workMicros[s] : 0;
+        if (s > 0) {
+            pipelineRingInit(&stage->input, PIPELINE_RING_CAPACITY);
+        }
+        stage->upstreamDone = 0;
+        stage->processed = stage->latencyMicros = stage->maxLatencyMicros = 0;
+        stage->stalls = stage->stallMicros = 0;
+    }
+    
+    kitchenPipeline.startedAt = benchNow();
+    kitchenPipeline.active = 0;
+    kitchenPipeline.moves = 0;
+    kitchenPipeline.running = 1;
+    int started = 1;
+    for (int s = 0; s < PIPELINE_STAGES; s++) {
+        PipelineStage *stage = &kitchenPipeline.stages[s];
+        int wanted = stage->workers;
+        for (int w = 0; w < wanted; w++) {
+            if (pthread_create(&stage->threads[w], NULL, pipelineWorker, stage) != 0) {
+                stage->workers = w;     /* stopKitchenPipeline() joins only these */
+                break;
+            }
+        }
+        if (stage->workers == 0) {
+            started = 0;
+        } else if (stage->workers < wanted) {
+            notify("⚠ %s stage started %d of %d workers\n", stage->name, stage->workers, wanted);
+        }
+    }
+    pthread_mutex_unlock(&kitchenPipeline.lock);
+    
+    if (!started) {
+        stopKitchenPipeline();
+        notify("✗ Could not start kitchen pipeline workers\n");
+        return -1;
+    }
+    notify("✓ Kitchen pipeline started (%d/%d/%d/%d workers)\n", kitchenPipeline.stages[0].workers,
+           kitchenPipeline.stages[1].workers, kitchenPipeline.stages[2].workers, kitchenPipeline.stages[3].workers);
+    return 1;
+}
+
+/* Drains front to back: each stage finishes what reached it before the
+ * next is told its input is closed. Unstarted orders stay on the stack and
+ * orders not due yet keep their status, for the admin to move on by hand */
+void stopKitchenPipeline() {
+    pthread_mutex_lock(&kitchenPipeline.lock);
+    if (!kitchenPipeline.running) {
+        pthread_mutex_unlock(&kitchenPipeline.lock);
+        return;
+    }
+    
+    for (int s = 0; s < PIPELINE_STAGES; s++) {
+        PipelineStage *stage = &kitchenPipeline.stages[s];
+        atomic_store(&stage->upstreamDone, 1);
+        for (int w = 0; w < stage->workers; w++) {
+            pthread_join(stage->threads[w], NULL);
+        }
+    }
+    for (int s = 1; s < PIPELINE_STAGES; s++) {
+        free(kitchenPipeline.stages[s].input.cells);
+        kitchenPipeline.stages[s].input.cells = NULL;
+    }
+    kitchenPipeline.stoppedAt = benchNow();
+    kitchenPipeline.running = 0;
+    pthread_mutex_unlock(&kitchenPipeline.lock);
+    
+    notify("✓ Kitchen pipeline stopped\n");
+}
+
+long long pipelineCompleted() {
+    return atomic_load(&kitchenPipeline.stages[PIPELINE_STAGES - 1].processed);
+}
+
+/* True when no order is on the stack, in a ring or in a worker's hands.
+ * Reads the move count on both sides, so an order handed on mid-check is not missed */
+int pipelineIdle() {
+    long long moves = atomic_load(&kitchenPipeline.moves);
+    pthread_mutex_lock(&orderStackLock);
+    int stacked = orderStackTop != NULL;
+    pthread_mutex_unlock(&orderStackLock);
+    if (stacked) return 0;
+    for (int s = 1; s < PIPELINE_STAGES; s++) {
+        if (pipelineRingDepth(&kitchenPipeline.stages[s].input) > 0) return 0;
+    }
+    if (atomic_load(&kitchenPipeline.active) > 0) return 0;
+    return atomic_load(&kitchenPipeline.moves) == moves;
+}
+
+void displayPipelineStats() {
+    if (kitchenPipeline.startedAt == 0) {
+        screenPrintf("Kitchen pipeline has not been started.\n");
+        screenFlush();
+        return;
+    }
+    
+    double elapsed = (kitchenPipeline.running ? benchNow() : kitchenPipeline.stoppedAt) - kitchenPipeline.startedAt;
+    screenPrintf("Pipeline %s, %.1f s\n\n", kitchenPipeline.running ? "running" : "stopped", elapsed);
+    screenPrintf("Stage\t\tWorkers\tHandoff\tQueued\tDone\tOrders/s\tAvg ms\tMax ms\tStalls\tStalled ms\n");
+    screenPrintf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
+    for (int s = 0; s < PIPELINE_STAGES; s++) {
+        PipelineStage *stage = &kitchenPipeline.stages[s];
+        long long processed = atomic_load(&stage->processed);
+        long queued = s == 0 ? 0 : kitchenPipeline.running ? (long)pipelineRingDepth(&stage->input) : 0;
+        char handoff[16];
+        if (stage->handoffSeconds == PIPELINE_BY_HAND) snprintf(handoff, sizeof(handoff), "by hand");
+        else snprintf(handoff, sizeof(handoff), "%ds", stage->handoffSeconds);
+        screenPrintf("%-10s\t%d\t%s\t%ld\t%lld\t%.1f\t\t%.2f\t%.2f\t%lld\t%.1f\n",
+                     stage->name, stage->workers, handoff, queued, processed,
+                     elapsed > 0 ? processed / elapsed : 0.0,
+                     processed > 0 ? atomic_load(&stage->latencyMicros) / 1000.0 / processed : 0.0,
+                     atomic_load(&stage->maxLatencyMicros) / 1000.0,
+                     atomic_load(&stage->stalls), atomic_load(&stage->stallMicros) / 1000.0);
+    }
+    screenFlush();
+}
+
+/* =============================== CREDENTIALS =============================== */
+static const unsigned int sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256Block(Sha256 *ctx, const unsigned char *block) {
+    unsigned int w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (unsigned int)block[i * 4] << 24 | (unsigned int)block[i * 4 + 1] << 16 |
+               (unsigned int)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        unsigned int s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        unsigned int s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    
+    unsigned int a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    unsigned int e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+    for (int i = 0; i < 64; i++) {
+        unsigned int t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+        unsigned int t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+    ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+void sha256Init(Sha256 *ctx) {
+    static const unsigned int initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void sha256Update(Sha256 *ctx, const void *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    ctx->length += length;
+    while (length > 0) {
+        size_t take = 64 - ctx->used < length ? 64 - ctx->used : length;
+        memcpy(ctx->block + ctx->used, bytes, take);
+        ctx->used += take;
+        bytes += take;
+        length -= take;
+        if (ctx->used == 64) {
+            sha256Block(ctx, ctx->block);
+            ctx->used = 0;
+        }
+    }
+}
+
+void sha256Final(Sha256 *ctx, unsigned char digest[32]) {
+    unsigned long long bits = ctx->length * 8;
+    unsigned char pad = 0x80;
+    sha256Update(ctx, &pad, 1);
+    pad = 0;
+    while (ctx->used != 56) {
+        sha256Update(ctx, &pad, 1);
+    }
+    unsigned char lengthBytes[8];
+    for (int i = 0; i < 8; i++) {
+        lengthBytes[i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+    sha256Update(ctx, lengthBytes, 8);
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)ctx->state[i];
+    }
+}
+
+/* Salts and tokens come only from the OS generator; without one there is nothing safe to issue */
+void randomBytes(unsigned char *out, size_t length) {
+#ifdef _WIN32
+    for (size_t done = 0; done < length; done += sizeof(unsigned int)) {
+        unsigned int value;
+        if (rand_s(&value) != 0) {
+            fprintf(stderr, "Secure random source unavailable\n");
+            exit(1);
+        }
+        memcpy(out + done, &value, length - done < sizeof(value) ? length - done : sizeof(value));
+    }
+#else
+    FILE *source = fopen("/dev/urandom", "rb");
+    size_t got = 0;
+    if (source != NULL) {
+        got = fread(out, 1, length, source);
+        fclose(source);
+    }
+    if (got != length) {
+        fprintf(stderr, "Secure random source unavailable\n");
+        exit(1);
+    }
+#endif
+}
+
+/* Touches every byte whatever the contents, so timing reveals nothing */
+int constantTimeEquals(const void *a, const void *b, size_t length) {
+    const volatile unsigned char *x = (const volatile unsigned char*)a;
+    const volatile unsigned char *y = (const volatile unsigned char*)b;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < length; i++) {
+        diff |= x[i] ^ y[i];
+    }
+    return diff == 0;
+}
+
+static void toHex(const unsigned char *bytes, size_t length, char *out) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++) {
+        out[i * 2] = digits[bytes[i] >> 4];
+        out[i * 2 + 1] = digits[bytes[i] & 15];
+    }
+    out[length * 2] = '\0';
+}
+
+static int fromHex(const char *text, size_t length, unsigned char *out) {
+    for (size_t i = 0; i < length * 2; i++) {
+        int c = tolower((unsigned char)text[i]);
+        int value = isdigit(c) ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+        if (value < 0) return 0;
+        out[i / 2] = (unsigned char)(i % 2 == 0 ? value << 4 : out[i / 2] | value);
+    }
+    return 1;
+}
+
+/* PBKDF2-HMAC-SHA256, one 32-byte block, 2^cost iterations.
+ * The keyed inner and outer states are computed once and copied per round. */
+void derivePasswordKey(const char *password, const unsigned char *salt, int cost, unsigned char key[32]) {
+    unsigned char pad[64] = {0};
+    size_t passwordLength = strlen(password);
+    if (passwordLength > 64) {
+        Sha256 ctx;
+        sha256Init(&ctx);
+        sha256Update(&ctx, password, passwordLength);
+        sha256Final(&ctx, pad);
+    } else {
+        memcpy(pad, password, passwordLength);
+    }
+    
+    Sha256 inner, outer;
+    sha256Init(&inner);
+    sha256Init(&outer);
+    for (int i = 0; i < 64; i++) pad[i] ^= 0x36;
+    sha256Update(&inner, pad, 64);
+    for (int i = 0; i < 64; i++) pad[i] ^= 0x36 ^ 0x5c;
+    sha256Update(&outer, pad, 64);
+    
+    unsigned char u[32];
+    static const unsigned char blockIndex[4] = {0, 0, 0, 1};
+    Sha256 ctx = inner;
+    sha256Update(&ctx, salt, PASSWORD_SALT_BYTES);
+    sha256Update(&ctx, blockIndex, 4);
+    sha256Final(&ctx, u);
+    ctx = outer;
+    sha256Update(&ctx, u, 32);
+    sha256Final(&ctx, u);
+    memcpy(key, u, 32);
+    
+    long iterations = 1L << cost;
+    for (long i = 1; i < iterations; i++) {
+        ctx = inner;
+        sha256Update(&ctx, u, 32);
+        sha256Final(&ctx, u);
+        ctx = outer;
+        sha256Update(&ctx, u, 32);
+        sha256Final(&ctx, u);
+        for (int j = 0; j < 32; j++) key[j] ^= u[j];
+    }
+}
+
+void hashPassword(const char *password, int cost, char *credential) {
+    unsigned char salt[PASSWORD_SALT_BYTES], key[32];
+    char saltHex[PASSWORD_SALT_BYTES * 2 + 1], keyHex[65];
+    randomBytes(salt, sizeof(salt));
+    derivePasswordKey(password, salt, cost, key);
+    toHex(salt, sizeof(salt), saltHex);
+    toHex(key, sizeof(key), keyHex);
+    snprintf(credential, MAX_PASSWORD_HASH, "$s256$%02d$%s$%s", cost, saltHex, keyHex);
+}
+
+static int parseCredential(const char *credential, int *cost, unsigned char *salt, unsigned char key[32]) {
+    if (strncmp(credential, "$s256$", 6) != 0 || !isdigit((unsigned char)credential[6])
+        || !isdigit((unsigned char)credential[7]) || credential[8] != '$'
+        || strlen(credential) != 9 + PASSWORD_SALT_BYTES * 2 + 1 + 64
+        || credential[9 + PASSWORD_SALT_BYTES * 2] != '$') {
+        return 0;
+    }
+    *cost = (credential[6] - '0') * 10 + (credential[7] - '0');
+    return *cost >= PASSWORD_MIN_COST && *cost <= PASSWORD_MAX_COST
+        && fromHex(credential + 9, PASSWORD_SALT_BYTES, salt)
+        && fromHex(credential + 10 + PASSWORD_SALT_BYTES * 2, 32, key);
+}
+
+/* Legacy plaintext credentials and hashes at another cost are rehashed on success */
+int verifyPassword(User *user, const char *password) {
+    unsigned char salt[PASSWORD_SALT_BYTES], expected[32], actual[32];
+    int cost;
+    
+    if (parseCredential(user->credential, &cost, salt, expected)) {
+        derivePasswordKey(password, salt, cost, actual);
+        if (!constantTimeEquals(actual, expected, sizeof(actual))) return 0;
+        if (cost == passwordCost) return 1;
+    } else {
+        char given[MAX_PASSWORD_HASH] = {0}, stored[MAX_PASSWORD_HASH] = {0};
+        snprintf(given, sizeof(given), "%s", password);
+        snprintf(stored, sizeof(stored), "%s", user->credential);
+        if (!constantTimeEquals(given, stored, sizeof(given))) return 0;
+    }
+    
+    hashPassword(password, passwordCost, user->credential);
+    return 1;
+}
+
+static unsigned int tokenBucket(const unsigned char *token, int bucketCount) {
+    unsigned int hash;
+    memcpy(&hash, token, sizeof(hash));      /* Tokens are random already */
+    return hash & (unsigned int)(bucketCount - 1);
+}
+
+/* Caller holds tokenCache.lock */
+static void pruneExpiredTokens(time_t now) {
+    for (int b = 0; b < tokenCache.bucketCount; b++) {
+        SessionToken **link = &tokenCache.buckets[b];
+        while (*link != NULL) {
+            SessionToken *entry = *link;
+            if (entry->expires <= now) {
+                *link = entry->next;
+                slabFree(&tokenPool, entry);
+                tokenCache.count--;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+void issueSessionToken(User *user, char *tokenHex) {
+    SessionToken *entry = (SessionToken*)slabAlloc(&tokenPool);
+    randomBytes(entry->token, SESSION_TOKEN_BYTES);
+    entry->user = user;
+    entry->expires = time(NULL) + SESSION_TOKEN_TTL;
+    toHex(entry->token, SESSION_TOKEN_BYTES, tokenHex);
+    
+    pthread_mutex_lock(&tokenCache.lock);
+    if (tokenCache.count >= tokenCache.bucketCount) {
+        pruneExpiredTokens(entry->expires - SESSION_TOKEN_TTL);
+    }
+    if (tokenCache.count >= tokenCache.bucketCount) {
+        int bucketCount = tokenCache.bucketCount ? tokenCache.bucketCount * 2 : 64;
+        SessionToken **buckets = (SessionToken**)xcalloc(bucketCount, sizeof(SessionToken*));
+        for (int b = 0; b < tokenCache.bucketCount; b++) {
+            SessionToken *node = tokenCache.buckets[b];
+            while (node != NULL) {
+                SessionToken *next = node->next;
+                unsigned int bucket = tokenBucket(node->token, bucketCount);
+                node->next = buckets[bucket];
+                buckets[bucket] = node;
+                node = next;
+            }
+        }
+        free(tokenCache.buckets);
+        tokenCache.buckets = buckets;
+        tokenCache.bucketCount = bucketCount;
+    }
+    
+    unsigned int bucket = tokenBucket(entry->token, tokenCache.bucketCount);
+    entry->next = tokenCache.buckets[bucket];
+    tokenCache.buckets[bucket] = entry;
+    tokenCache.count++;
+    pthread_mutex_unlock(&tokenCache.lock);
+}
+
+/* Logout and session close make the token unusable at once */
+void revokeSessionToken(const char *tokenHex) {
+    unsigned char token[SESSION_TOKEN_BYTES];
+    if (strlen(tokenHex) != SESSION_TOKEN_BYTES * 2 || !fromHex(tokenHex, SESSION_TOKEN_BYTES, token)) {
+        return;
+    }
+    
+    pthread_mutex_lock(&tokenCache.lock);
+    if (tokenCache.bucketCount > 0) {
+        SessionToken **link = &tokenCache.buckets[tokenBucket(token, tokenCache.bucketCount)];
+        while (*link != NULL && !constantTimeEquals((*link)->token, token, SESSION_TOKEN_BYTES)) {
+            link = &(*link)->next;
+        }
+        if (*link != NULL) {
+            SessionToken *entry = *link;
+            *link = entry->next;
+            slabFree(&tokenPool, entry);
+            tokenCache.count--;
+        }
+    }
+    pthread_mutex_unlock(&tokenCache.lock);
+}
+
+/* O(1) re-authentication: one bucket probe, no password hashing */
+User* authenticateToken(const char *tokenHex) {
+    unsigned char token[SESSION_TOKEN_BYTES];
+    if (strlen(tokenHex) != SESSION_TOKEN_BYTES * 2 || !fromHex(tokenHex, SESSION_TOKEN_BYTES, token)) {
+        return NULL;
+    }
+    
+    User *user = NULL;
+    pthread_mutex_lock(&tokenCache.lock);
+    if (tokenCache.bucketCount > 0) {
+        for (SessionToken *entry = tokenCache.buckets[tokenBucket(token, tokenCache.bucketCount)];
+             entry != NULL; entry = entry->next) {
+            if (constantTimeEquals(entry->token, token, SESSION_TOKEN_BYTES)) {
+                if (entry->expires > time(NULL)) user = entry->user;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&tokenCache.lock);
+    return user;
+}
+
+/* Token nodes go back with tokenPool */
+void releaseSessionTokens() {
+    pthread_mutex_lock(&tokenCache.lock);
+    free(tokenCache.buckets);
+    tokenCache.buckets = NULL;
+    tokenCache.bucketCount = tokenCache.count = 0;
+    pthread_mutex_unlock(&tokenCache.lock);
+}
+
+/* =============================== AVL TREE - USER MANAGEMENT =============================== */
+/* Stores the credential as given; callers hash new passwords with hashPassword() */
+User* createUser(const char *username, const char *credential, const char *address, const char *phone) {
+    User *newUser = (User*)xmalloc(sizeof(User));
+    strcpy(newUser->username, username);
+    strcpy(newUser->credential, credential);
+    strcpy(newUser->address, address);
+    strcpy(newUser->phone, phone);
+    newUser->loyaltyPoints = 0;
+    newUser->height = 1;
+    newUser->left = NULL;
+    newUser->right = NULL;
+    return newUser;
+}
+
+int userHeight(User *node) {
+    return node ? node->height : 0;
+}
+
+User* rightRotateUser(User *y) {
+    User *x = y->left;
+    y->left = x->right;
+    x->right = y;
+    
+    y->height = maxInt(userHeight(y->left), userHeight(y->right)) + 1;
+    x->height = maxInt(userHeight(x->left), userHeight(x->right)) + 1;
+    
+    return x;
+}
+
+User* leftRotateUser(User *x) {
+    User *y = x->right;
+    x->right = y->left;
+    y->left = x;
+    
+    x->height = maxInt(userHeight(x->left), userHeight(x->right)) + 1;
+    y->height = maxInt(userHeight(y->left), userHeight(y->right)) + 1;
+    
+    return y;
+}
+
+User* insertUser(User *root, User *newUser) {
+    User *path[USER_TREE_MAX_DEPTH];
+    int depth = 0;
+    
+    /* Walk down, remembering the path for rebalancing */
+    User *current = root;
+    while (current != NULL) {
+        int cmp = strcmp(newUser->username, current->username);
+        if (cmp == 0) {
+            notify("✗ Username already exists!\n");
+            free(newUser);
+            return root;
+        }
+        path[depth++] = current;
+        current = (cmp < 0) ? current->left : current->right;
+    }
+    
+    newUser->height = 1;
+    newUser->left = newUser->right = NULL;
+    if (depth == 0) {
+        return newUser;
+    }
+    
+    if (strcmp(newUser->username, path[depth - 1]->username) < 0) {
+        path[depth - 1]->left = newUser;
+    } else {
+        path[depth - 1]->right = newUser;
+    }
+    
+    /* Walk back up, fixing heights and rotating where the balance breaks */
+    for (int i = depth - 1; i >= 0; i--) {
+        User *node = path[i];
+        node->height = 1 + maxInt(userHeight(node->left), userHeight(node->right));
+        int balance = userHeight(node->left) - userHeight(node->right);
+        User *subtree = node;
+        
+        if (balance > 1) {
+            if (strcmp(newUser->username, node->left->username) > 0) {
+                node->left = leftRotateUser(node->left);
+            }
+            subtree = rightRotateUser(node);
+        } else if (balance < -1) {
+            if (strcmp(newUser->username, node->right->username) < 0) {
+                node->right = rightRotateUser(node->right);
+            }
+            subtree = leftRotateUser(node);
+        }
+        
+        if (subtree != node) {
+            if (i == 0) {
+                return subtree;
+            }
+            if (path[i - 1]->left == node) {
+                path[i - 1]->left = subtree;
+            } else {
+                path[i - 1]->right = subtree;
+            }
+            break;  /* One rotation restores the height, ancestors are unchanged */
+        }
+    }
+    
+    return root;
+}
+
+User* searchUser(User *root, const char *username) {
+    User *current = root;
+    while (current != NULL) {
+        int cmp = strcmp(username, current->username);
+        if (cmp == 0) return current;
+        current = (cmp < 0) ? current->left : current->right;
+    }
+    return NULL;
+}
+
+int isAdminUser(const User *user) {
+    return user != NULL && strcmp(user->username, "admin") == 0;
+}
+
+void displayUsersInorder(User *root) {
+    User *stack[USER_TREE_MAX_DEPTH];
+    int top = 0;
+    User *current = root;
+    
+    while (current != NULL || top > 0) {
+        while (current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        current = stack[--top];
+        screenPrintf("%-15s\t%-30s\t%s\t%d points\n", 
+                     current->username, current->address, current->phone, current->loyaltyPoints);
+        current = current->right;
+    }
+    screenFlush();
+}
+
+void addLoyaltyPoints(const char *username, float purchaseAmount) {
+    User *user = searchUser(userRoot, username);
+    if (user != NULL) {
+        int points = (int)(purchaseAmount * 10);
+        atomic_fetch_add(&user->loyaltyPoints, points);
+        notify("✓ Added %d loyalty points to %s\n", points, username);
+    }
+}
+
+/* =============================== B+-STYLE LEAF BLOCKS - ORDER HISTORY =============================== */
+int maxInt(int a, int b) {
+    return (a > b) ? a : b;
+}
+
+static void addHistoryStats(HistoryStats *into, const HistoryStats *from, int sign) {
+    into->count += sign * from->count;
+    into->revenue += sign * from->revenue;
+    into->discounts += sign * from->discounts;
+    into->taxes += sign * from->taxes;
+}
+
+/* Recomputes the running sums of one leaf from entry `from` on */
+static void updateLeafPrefix(HistoryLeaf *leaf, int from) {
+    for (int i = from; i < leaf->count; i++) {
+        Order *order = orderAt(leaf->handles[i]);
+        HistoryStats *stats = &leaf->prefix[i];
+        if (i == 0) {
+            memset(stats, 0, sizeof(*stats));
+        } else {
+            *stats = leaf->prefix[i - 1];
+        }
+        stats->count++;
+        stats->revenue += order->total;
+        stats->discounts += order->discount;
+        stats->taxes += order->tax;
+    }
+}
+
+/* Refreshes separators and before-sums for leaves `from`.. (O(1) for appends) */
+static void updateLeafDirectory(int from) {
+    for (int l = from; l < history.leafCount; l++) {
+        HistoryLeaf *leaf = history.leaves[l];
+        history.leafFirstId[l] = leaf->orderIds[0];
+        history.leafFirstTime[l] = leaf->orderTimes[0];
+        if (l == 0) {
+            memset(&history.leafBefore[l], 0, sizeof(HistoryStats));
+        } else {
+            history.leafBefore[l] = history.leafBefore[l - 1];
+            addHistoryStats(&history.leafBefore[l], &history.leaves[l - 1]->prefix[history.leaves[l - 1]->count - 1], 1);
+        }
+        history.leaves[l]->next = (l + 1 < history.leafCount) ? history.leaves[l + 1] : NULL;
+    }
+}
+
+static HistoryLeaf* insertHistoryLeaf(int position) {
+    if (history.leafCount == history.leafCapacity) {
+        history.leafCapacity = history.leafCapacity ? history.leafCapacity * 2 : 64;
+        history.leaves = (HistoryLeaf**)xrealloc(history.leaves, sizeof(HistoryLeaf*) * history.leafCapacity);
+        history.leafFirstId = (int*)xrealloc(history.leafFirstId, sizeof(int) * history.leafCapacity);
+        history.leafFirstTime = (time_t*)xrealloc(history.leafFirstTime, sizeof(time_t) * history.leafCapacity);
+        history.leafBefore = (HistoryStats*)xrealloc(history.leafBefore, sizeof(HistoryStats) * history.leafCapacity);
+    }
+    
+    int tail = history.leafCount - position;
+    memmove(&history.leaves[position + 1], &history.leaves[position], sizeof(HistoryLeaf*) * tail);
+    memmove(&history.leafFirstId[position + 1], &history.leafFirstId[position], sizeof(int) * tail);
+    memmove(&history.leafFirstTime[position + 1], &history.leafFirstTime[position], sizeof(time_t) * tail);
+    memmove(&history.leafBefore[position + 1], &history.leafBefore[position], sizeof(HistoryStats) * tail);
+    
+    HistoryLeaf *leaf = (HistoryLeaf*)slabAlloc(&historyPool);
+    leaf->count = 0;
+    leaf->next = NULL;
+    history.leaves[position] = leaf;
+    history.leafCount++;
+    return leaf;
+}
+
+/* Last leaf whose first id is <= orderId, -1 if orderId precedes them all */
+static int findHistoryLeaf(int orderId) {
+    int low = 0, high = history.leafCount - 1, found = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (history.leafFirstId[mid] <= orderId) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return found;
+}
+
+/* Entries of a leaf with id < orderId */
+static int leafLowerBound(const HistoryLeaf *leaf, int orderId) {
+    int low = 0, high = leaf->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (leaf->orderIds[mid] < orderId) low = mid + 1; else high = mid;
+    }
+    return low;
+}
+
+/* O(1) when orderId is the largest so far; out-of-order ids split a leaf */
+void appendOrderHistory(OrderHandle handle) {
+    int orderId = orderAt(handle)->orderId;
+    
+    pthread_mutex_lock(&historyLock);
+    int l = findHistoryLeaf(orderId);
+    if (l == -1) l = 0;
+    
+    HistoryLeaf *leaf = history.leafCount > 0 ? history.leaves[l] : NULL;
+    int position = leaf != NULL ? leafLowerBound(leaf, orderId) : 0;
+    if (leaf != NULL && position < leaf->count && leaf->orderIds[position] == orderId) {
+        pthread_mutex_unlock(&historyLock);
+        return;
+    }
+    
+    if (leaf == NULL || (leaf->count == HISTORY_LEAF_KEYS && position == HISTORY_LEAF_KEYS &&
+                         l == history.leafCount - 1)) {
+        /* Append path: start a fresh leaf at the end, leaving the old one full */
+        l = history.leafCount;
+        leaf = insertHistoryLeaf(l);
+        position = 0;
+    } else if (leaf->count == HISTORY_LEAF_KEYS) {
+        /* Split: the upper half moves to a new leaf after this one */
+        HistoryLeaf *upper = insertHistoryLeaf(l + 1);
+        int half = HISTORY_LEAF_KEYS / 2;
+        upper->count = HISTORY_LEAF_KEYS - half;
+        memcpy(upper->orderIds, &leaf->orderIds[half], sizeof(int) * upper->count);
+        memcpy(upper->handles, &leaf->handles[half], sizeof(OrderHandle) * upper->count);
+        memcpy(upper->orderTimes, &leaf->orderTimes[half], sizeof(time_t) * upper->count);
+        leaf->count = half;
+        updateLeafPrefix(upper, 0);
+        if (position > half) {
+            leaf = upper;
+            l++;
+            position -= half;
+        }
+    }
+    
+    int tail = leaf->count - position;
+    memmove(&leaf->orderIds[position + 1], &leaf->orderIds[position], sizeof(int) * tail);
+    memmove(&leaf->handles[position + 1], &leaf->handles[position], sizeof(OrderHandle) * tail);
+    memmove(&leaf->orderTimes[position + 1], &leaf->orderTimes[position], sizeof(time_t) * tail);
+    leaf->orderIds[position] = orderId;
+    leaf->handles[position] = handle;
+    leaf->orderTimes[position] = orderAt(handle)->orderTime;
+    leaf->count++;
+    history.count++;
+    
+    updateLeafPrefix(leaf, position);
+    updateLeafDirectory(l > 0 ? l - 1 : 0);
+    pthread_mutex_unlock(&historyLock);
+}
+
+/* O(n) bulk load from handles already sorted by order id: full leaves, built left to right */
+void buildOrderHistory(const OrderHandle *handles, int count) {
+    releaseOrderHistory();
+    
+    pthread_mutex_lock(&historyLock);
+    for (int i = 0; i < count; i += HISTORY_LEAF_KEYS) {
+        HistoryLeaf *leaf = insertHistoryLeaf(history.leafCount);
+        leaf->count = (count - i < HISTORY_LEAF_KEYS) ? count - i : HISTORY_LEAF_KEYS;
+        for (int j = 0; j < leaf->count; j++) {
+            Order *order = orderAt(handles[i + j]);
+            leaf->orderIds[j] = order->orderId;
+            leaf->handles[j] = handles[i + j];
+            leaf->orderTimes[j] = order->orderTime;
+        }
+        updateLeafPrefix(leaf, 0);
+    }
+    history.count = count;
+    updateLeafDirectory(0);
+    pthread_mutex_unlock(&historyLock);
+}
+
+static int compareHandleIds(const void *a, const void *b) {
+    int idA = orderAt(*(const OrderHandle*)a)->orderId;
+    int idB = orderAt(*(const OrderHandle*)b)->orderId;
+    return (idA > idB) - (idA < idB);
+}
+
+/* Startup: every stored order, already in id order unless checkouts interleaved */
+void rebuildOrderHistory() {
+    int count = orderStore.count;
+    OrderHandle *handles = (OrderHandle*)xmalloc(sizeof(OrderHandle) * (count + 1));
+    int sorted = 1;
+    for (OrderHandle handle = 0; handle < count; handle++) {
+        handles[handle] = handle;
+        if (handle > 0 && orderAt(handle)->orderId < orderAt(handle - 1)->orderId) {
+            sorted = 0;
+        }
+    }
+    if (!sorted) {
+        qsort(handles, count, sizeof(OrderHandle), compareHandleIds);
+    }
+    buildOrderHistory(handles, count);
+    free(handles);
+}
+
+void releaseOrderHistory() {
+    pthread_mutex_lock(&historyLock);
+    for (int l = 0; l < history.leafCount; l++) {
+        slabFree(&historyPool, history.leaves[l]);
+    }
+    free(history.leaves);
+    free(history.leafFirstId);
+    free(history.leafFirstTime);
+    free(history.leafBefore);
+    memset(&history, 0, sizeof(history));
+    pthread_mutex_unlock(&historyLock);
+}
+
+void displayOrderHistory() {
+    pthread_mutex_lock(&historyLock);
+    for (HistoryLeaf *leaf = history.leafCount > 0 ? history.leaves[0] : NULL; leaf != NULL; leaf = leaf->next) {
+        for (int i = 0; i < leaf->count; i++) {
+            Order *order = orderAt(leaf->handles[i]);
+            screenPrintf("#%d\t\t%s\t\t%s\t\t$%.2f\t%s", 
+                         order->orderId, orderUsername(order), 
+                         getStatusText(order->status), order->total, 
+                         formatTimestamp(order->orderTime));
+        }
+    }
+    pthread_mutex_unlock(&historyLock);
+    screenFlush();
+}
+
+Order* searchOrderHistoryById(int orderId) {
+    Order *found = NULL;
+    
+    pthread_mutex_lock(&historyLock);
+    int l = findHistoryLeaf(orderId);
+    if (l != -1) {
+        HistoryLeaf *leaf = history.leaves[l];
+        int position = leafLowerBound(leaf, orderId);
+        if (position < leaf->count && leaf->orderIds[position] == orderId) {
+            found = orderAt(leaf->handles[position]);
+        }
+    }
+    pthread_mutex_unlock(&historyLock);
+    return found;
+}
+
+/* Aggregates of every order with id < orderId (byTime = 0) or orderTime < time */
+static HistoryStats historyPrefix(int orderId, time_t time, int byTime) {
+    HistoryStats stats = {0, 0, 0, 0};
+    
+    pthread_mutex_lock(&historyLock);
+    int low = 0, high = history.leafCount - 1, l = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int before = byTime ? history.leafFirstTime[mid] < time : history.leafFirstId[mid] < orderId;
+        if (before) {
+            l = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    
+    if (l != -1) {
+        HistoryLeaf *leaf = history.leaves[l];
+        int position = 0;
+        if (byTime) {
+            while (position < leaf->count && leaf->orderTimes[position] < time) position++;
+        } else {
+            position = leafLowerBound(leaf, orderId);
+        }
+        stats = history.leafBefore[l];
+        addHistoryStats(&stats, &leaf->prefix[position - 1], 1);
+    }
+    pthread_mutex_unlock(&historyLock);
+    return stats;
+}
+
+/* Orders with firstId <= orderId <= lastId */
+HistoryStats historyRangeById(int firstId, int lastId) {
+    if (lastId < firstId) {
+        HistoryStats none = {0, 0, 0, 0};
+        return none;
+    }
+    
+    HistoryStats stats = historyPrefix(lastId < INT_MAX ? lastId + 1 : INT_MAX, 0, 0);
+    HistoryStats before = historyPrefix(firstId, 0, 0);
+    addHistoryStats(&stats, &before, -1);
+    return stats;
+}
+
+/* Orders placed in [from, to) */
+HistoryStats historyRangeByTime(time_t from, time_t to) {
+    HistoryStats stats = historyPrefix(0, to, 1);
+    HistoryStats before = historyPrefix(0, from, 1);
+    addHistoryStats(&stats, &before, -1);
+    return stats;
+}
+
+/* Number of orders with a smaller id */
+int historyRank(int orderId) {
+    return historyPrefix(orderId, 0, 0).count;
+}
+
+/* k-th order by id, 0-based; -1 when out of range */
+OrderHandle historySelect(int k) {
+    OrderHandle handle = -1;
+    
+    pthread_mutex_lock(&historyLock);
+    if (k >= 0 && k < history.count) {
+        /* Last leaf with fewer than k+1 orders before it */
+        int low = 0, high = history.leafCount - 1, l = 0;
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            if (history.leafBefore[mid].count <= k) {
+                l = mid;
+                low = mid + 1;
+            } else {
+                high = mid - 1;
+            }
+        }
+        handle = history.leaves[l]->handles[k - history.leafBefore[l].count];
+    }
+    pthread_mutex_unlock(&historyLock);
+    return handle;
+}
+
+/* Cursor pagination: up to k order ids following afterOrderId, oldest first */
+int historyPage(int afterOrderId, int k, int *orderIds) {
+    if (afterOrderId == INT_MAX) return 0;
+    
+    int found = 0;
+    pthread_mutex_lock(&historyLock);
+    int l = findHistoryLeaf(afterOrderId + 1);
+    HistoryLeaf *leaf = history.leafCount > 0 ? history.leaves[l == -1 ? 0 : l] : NULL;
+    int position = leaf != NULL ? leafLowerBound(leaf, afterOrderId + 1) : 0;
+    
+    /* Walk the leaf chain from the cursor */
+    while (leaf != NULL && found < k) {
+        if (position == leaf->count) {
+            leaf = leaf->next;
+            position = 0;
+            continue;
+        }
+        orderIds[found++] = leaf->orderIds[position++];
+    }
+    pthread_mutex_unlock(&historyLock);
+    return found;
+}
+
+void displayHistoryStats(const char *label, HistoryStats stats) {
+    screenPrintf("%s\n", label);
+    screenPrintf("Orders:     %d\n", stats.count);
+    screenPrintf("Revenue:    $%.2f\n", stats.revenue);
+    screenPrintf("Discounts:  $%.2f\n", stats.discounts);
+    screenPrintf("Taxes:      $%.2f\n", stats.taxes);
+    if (stats.count > 0) {
+        screenPrintf("Average:    $%.2f\n", stats.revenue / stats.count);
+    }
+    screenFlush();
+}
+
+/* Prints one page (newest first) of an account's orders; returns 1 if older ones remain */
+int displayUserOrderHistory(int accountId, int page) {
+    int orderIds[ORDER_HISTORY_PAGE];
+    int skip = page * ORDER_HISTORY_PAGE;
+    int found = recentAccountOrders(accountId, skip, ORDER_HISTORY_PAGE, orderIds);
+    
+    for (int i = 0; i < found; i++) {
+        Order *order = searchOrderById(orderIds[i]);
+        screenPrintf("#%d\t\t%s\t\t$%.2f\t%s", 
+                     order->orderId, getStatusText(order->status), 
+                     order->total, formatTimestamp(order->orderTime));
+    }
+    screenFlush();
+    return skip + found < accountOrderCount(accountId);
+}
+
+/* =============================== SALES ANALYTICS =============================== */
+static void growAnalyticsColumns() {
+    if (menuCatalog.count > analytics.itemCapacity) {
+        int capacity = analytics.itemCapacity ? analytics.itemCapacity : 64;
+        while (capacity < menuCatalog.count) capacity *= 2;
+        analytics.itemRevenue = (double*)xrealloc(analytics.itemRevenue, sizeof(double) * capacity);
+        analytics.itemUnits = (long long*)xrealloc(analytics.itemUnits, sizeof(long long) * capacity);
+        for (int i = analytics.itemCapacity; i < capacity; i++) {
+            analytics.itemRevenue[i] = 0;
+            analytics.itemUnits[i] = 0;
+        }
+        analytics.itemCapacity = capacity;
+    }
+    if (menuCatalog.categoryCount > analytics.categoryCapacity) {
+        int capacity = analytics.categoryCapacity ? analytics.categoryCapacity : 16;
+        while (capacity < menuCatalog.categoryCount) capacity *= 2;
+        analytics.categoryRevenue = (double*)xrealloc(analytics.categoryRevenue, sizeof(double) * capacity);
+        for (int i = analytics.categoryCapacity; i < capacity; i++) {
+            analytics.categoryRevenue[i] = 0;
+        }
+        analytics.categoryCapacity = capacity;
+    }
+    if (analytics.orderCount == analytics.orderCapacity) {
+        analytics.orderCapacity = analytics.orderCapacity ? analytics.orderCapacity * 2 : 1024;
+        analytics.orderTotal = (float*)xrealloc(analytics.orderTotal, sizeof(float) * analytics.orderCapacity);
+        analytics.orderDiscount = (float*)xrealloc(analytics.orderDiscount, sizeof(float) * analytics.orderCapacity);
+        analytics.orderUnits = (int*)xrealloc(analytics.orderUnits, sizeof(int) * analytics.orderCapacity);
+    }
+}
+
+/* Called once per placed order, after its lines and totals are final */
+void recordSale(const Order *order) {
+    pthread_mutex_lock(&analytics.lock);
+    growAnalyticsColumns();
+    
+    int units = 0;
+    for (int i = 0; i < order->itemCount; i++) {
+        OrderLine *line = orderLineAt(order, i);
+        FoodItem *item = findMenuItem(line->itemId);
+        units += line->quantity;
+        if (item == NULL) continue;
+        
+        double revenue = (double)line->price * line->quantity;
+        analytics.itemRevenue[item->slot] += revenue;
+        analytics.itemUnits[item->slot] += line->quantity;
+        analytics.categoryRevenue[item->category] += revenue;
+    }
+    
+    long long index = analytics.orderCount++;
+    analytics.orderTotal[index] = order->total;
+    analytics.orderDiscount[index] = order->discount;
+    analytics.orderUnits[index] = units;
+    if (order->discount > 0) {
+        analytics.promoOrders++;
+    }
+    pthread_mutex_unlock(&analytics.lock);
+}
+
+void releaseSalesAnalytics() {
+    free(analytics.itemRevenue);
+    free(analytics.itemUnits);
+    free(analytics.categoryRevenue);
+    free(analytics.orderTotal);
+    free(analytics.orderDiscount);
+    free(analytics.orderUnits);
+    analytics.itemRevenue = NULL;
+    analytics.itemUnits = NULL;
+    analytics.categoryRevenue = NULL;
+    analytics.orderTotal = NULL;
+    analytics.orderDiscount = NULL;
+    analytics.orderUnits = NULL;
+    analytics.itemCapacity = analytics.categoryCapacity = 0;
+    analytics.orderCount = analytics.orderCapacity = 0;
+    analytics.promoOrders = 0;
+}
+
+/* Startup: replays every stored order into fresh columns */
+void rebuildSalesAnalytics() {
+    releaseSalesAnalytics();
+    for (OrderHandle handle = 0; handle < orderStore.count; handle++) {
+        recordSale(orderAt(handle));
+    }
+}
+
+/* Re-aggregates sales first..last-1 straight from the columns. Eight
+ * independent accumulators per column let the compiler vectorise. */
+SalesSummary summarizeSales(long long first, long long last) {
+    SalesSummary summary = {0, 0, 0, 0, 0};
+    
+    pthread_mutex_lock(&analytics.lock);
+    if (last > analytics.orderCount) last = analytics.orderCount;
+    if (first < 0) first = 0;
+    
+    if (first < last) {
+        const float *total = analytics.orderTotal;
+        const float *discount = analytics.orderDiscount;
+        const int *units = analytics.orderUnits;
+        double revenue[8] = {0}, discounts[8] = {0};
+        long long unitSum[8] = {0}, promo[8] = {0};
+        
+        long long i = first;
+        for (; i + 8 <= last; i += 8) {
+            for (int lane = 0; lane < 8; lane++) {
+                revenue[lane] += total[i + lane];
+                discounts[lane] += discount[i + lane];
+                unitSum[lane] += units[i + lane];
+                promo[lane] += discount[i + lane] > 0.0f;
+            }
+        }
+        for (; i < last; i++) {
+            revenue[0] += total[i];
+            discounts[0] += discount[i];
+            unitSum[0] += units[i];
+            promo[0] += discount[i] > 0.0f;
+        }
+        
+        for (int lane = 0; lane < 8; lane++) {
+            summary.revenue += revenue[lane];
+            summary.discounts += discounts[lane];
+            summary.units += unitSum[lane];
+            summary.promoOrders += promo[lane];
+        }
+        summary.orders = last - first;
+    }
+    pthread_mutex_unlock(&analytics.lock);
+    return summary;
+}
+
+/* Best sellers by units: one pass over the units column with an n-slot insertion list.
+ * Units and revenue (either may be NULL) are copied out under the lock, since a concurrent
+ * recordSale may grow and move the columns */
+int topSellingItems(int n, int *slots, long long *units, double *revenue) {
+    long long best[ANALYTICS_TOP_N];
+    int found = 0;
+    if (n > ANALYTICS_TOP_N) n = ANALYTICS_TOP_N;
+    
+    pthread_mutex_lock(&analytics.lock);
+    int items = analytics.itemCapacity < menuCatalog.count ? analytics.itemCapacity : menuCatalog.count;
+    for (int slot = 0; slot < items; slot++) {
+        long long sold = analytics.itemUnits[slot];
+        if (sold == 0 || (found == n && sold <= best[n - 1])) continue;
+        
+        int position = found < n ? found++ : n - 1;
+        while (position > 0 && best[position - 1] < sold) {
+            best[position] = best[position - 1];
+            slots[position] = slots[position - 1];
+            position--;
+        }
+        best[position] = sold;
+        slots[position] = slot;
+    }
+    for (int i = 0; i < found; i++) {
+        if (units != NULL) units[i] = best[i];
+        if (revenue != NULL) revenue[i] = analytics.itemRevenue[slots[i]];
+    }
+    pthread_mutex_unlock(&analytics.lock);
+    return found;
+}
+
+void displaySalesAnalytics() {
+    double start = benchNow();
+    SalesSummary summary = summarizeSales(0, LLONG_MAX);
+    int top[ANALYTICS_TOP_N];
+    long long topUnits[ANALYTICS_TOP_N];
+    double topRevenue[ANALYTICS_TOP_N];
+    int topCount = topSellingItems(ANALYTICS_TOP_N, top, topUnits, topRevenue);
+    
+    /* A concurrent recordSale may grow (and move) the category column too, so it is copied under the lock */
+    pthread_mutex_lock(&analytics.lock);
+    int categoryCount = menuCatalog.categoryCount < analytics.categoryCapacity ? menuCatalog.categoryCount : analytics.categoryCapacity;
+    double *categoryRevenue = (double*)xmalloc(sizeof(double) * (categoryCount > 0 ? categoryCount : 1));
+    if (categoryCount > 0) {
+        memcpy(categoryRevenue, analytics.categoryRevenue, sizeof(double) * categoryCount);
+    }
+    pthread_mutex_unlock(&analytics.lock);
+    double elapsed = benchNow() - start;
+    
+    screenPrintf("Orders:              %lld\n", summary.orders);
+    screenPrintf("Revenue:             $%.2f\n", summary.revenue);
+    screenPrintf("Discounts given:     $%.2f\n", summary.discounts);
+    if (summary.orders > 0) {
+        screenPrintf("Average order:       $%.2f\n", summary.revenue / summary.orders);
+        screenPrintf("Average basket:      %.2f items\n", (double)summary.units / summary.orders);
+        screenPrintf("Promo usage:         %lld orders (%.1f%%)\n", summary.promoOrders,
+                     100.0 * summary.promoOrders / summary.orders);
+    }
+    
+    screenPrintf("\nREVENUE BY CATEGORY:\n");
+    screenPrintf("────────────────────────────────────────────────\n");
+    for (int c = 0; c < categoryCount; c++) {
+        screenPrintf("%-20s\t$%.2f\n", menuCatalog.categories[c].name, categoryRevenue[c]);
+    }
+    free(categoryRevenue);
+    
+    screenPrintf("\nTOP %d BEST SELLERS:\n", ANALYTICS_TOP_N);
+    screenPrintf("────────────────────────────────────────────────\n");
+    for (int i = 0; i < topCount; i++) {
+        FoodItem *item = menuItemAt(top[i]);
+        screenPrintf("%d. %-20s\t%lld sold\t$%.2f\n", i + 1, menuItemName(item),
+                     topUnits[i], topRevenue[i]);
+    }
+    screenPrintf("\n(computed in %.2f ms)\n", elapsed * 1000);
+    screenFlush();
+}
+
+/* =============================== ORDER TRACKING FUNCTIONS =============================== */
+Order* searchOrderById(int orderId) {
+    OrderHandle handle = findOrderHandle(orderId);
+    return handle == -1 ? NULL : orderAt(handle);
+}
+
+void displayOrderStatus(int orderId, const char *username, int isAdmin) {
+    printHeader("ORDER TRACKING");
+    
+    Order *order = searchOrderById(orderId);
+    if (order == NULL) {
+        screenPrintf("Order #%d not found!\n", orderId);
+        screenFlush();
+        return;
+    }
+    
+    /* Check if user is authorized to view this order */
+    if (!isAdmin && strcmp(orderUsername(order), username) != 0) {
+        screenPrintf("Access denied! You can only view your own orders.\n");
+        screenFlush();
+        return;
+    }
+    
+    displayOrderDetails(order);
+    
+    /* Show delivery progress */
+    screenPrintf("\nDELIVERY PROGRESS:\n");
+    screenPrintf("[");
+    for (int i = 0; i <= 4; i++) {
+        if (order->status >= i) {
+            screenPrintf("█");
+        } else {
+            screenPrintf("░");
+        }
+    }
+    screenPrintf("]\n");
+    
+    /* Show status timeline */
+    screenPrintf("\nSTATUS TIMELINE:\n");
+    screenPrintf("1. Order Placed: %s", order->status >= 0 ? "✓ Completed\n" : "○ Pending\n");
+    screenPrintf("2. Order Confirmed: %s", order->status >= 1 ? "✓ Completed\n" : "○ Pending\n");
+    screenPrintf("3. Food Preparation: %s", order->status >= 2 ? "✓ Completed\n" : "○ Pending\n");
+    screenPrintf("4. Out for Delivery: %s", order->status >= 3 ? "✓ Completed\n" : "○ Pending\n");
+    screenPrintf("5. Order Delivered: %s", order->status >= 4 ? "✓ Completed\n" : "○ Pending\n");
+    
+    /* Estimated delivery time from the live queue and measured stage times */
+    screenPrintf("\nESTIMATED DELIVERY TIME:\n");
+    int ahead;
+    time_t estimatedTime = estimateDelivery(order, &ahead);
+    if (order->status == 5) {
+        screenPrintf("Order cancelled\n");
+    } else if (order->status == 4) {
+        screenPrintf("Delivered at: %s", formatTimestamp(estimatedTime));
+    } else {
+        screenPrintf("Expected by: %s", formatTimestamp(estimatedTime));
+        if (ahead >= 0) {
+            screenPrintf("Orders ahead in the delivery queue: %d\n", ahead);
+        }
+    }
+    screenFlush();
+}
+
+/* =============================== ORDER JOURNAL =============================== */
+unsigned int crc32(const void *data, size_t length) {
+    static unsigned int table[256];
+    static int tableReady = 0;
+    
+    if (!tableReady) {
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        tableReady = 1;
+    }
+    
+    const unsigned char *bytes = (const unsigned char*)data;
+    unsigned int crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void journalWrite(FILE *file, int type, const void *payload, unsigned int length) {
+    JournalHeader header;
+    header.magic = JOURNAL_MAGIC;
+    header.type = type;
+    header.length = length;
+    header.crc = crc32(payload, length);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(payload, 1, length, file);
+}
+
+static unsigned int encodeJournalOrder(const Order *order, unsigned char **buffer) {
+    unsigned int length = sizeof(JournalOrder) + sizeof(JournalItem) * order->itemCount;
+    *buffer = (unsigned char*)xcalloc(1, length);
+    
+    JournalOrder *record = (JournalOrder*)*buffer;
+    record->orderId = order->orderId;
+    Customer *customer = customerAt(order->customerId);
+    strcpy(record->username, accountName(customer->accountId));
+    strcpy(record->address, customer->address);
+    strcpy(record->phone, customer->phone);
+    record->subtotal = order->subtotal;
+    record->discount = order->discount;
+    record->deliveryFee = order->deliveryFee;
+    record->tax = order->tax;
+    record->total = order->total;
+    record->priority = order->priority;
+    record->status = order->status;
+    record->orderTime = order->orderTime;
+    record->statusTime = order->statusTime;
+    record->itemCount = order->itemCount;
+    
+    copyOrderLines(order, (JournalItem*)(*buffer + sizeof(JournalOrder)));
+    return length;
+}
+
+static void journalSyncLocked() {
+    if (orderJournal.file == NULL || orderJournal.pending == 0) return;
+    
+    fflush(orderJournal.file);
+    syncFile(fileno(orderJournal.file));
+    orderJournal.pending = 0;
+}
+
+void journalAppend(int type, const void *payload, unsigned int length) {
+    pthread_mutex_lock(&journalLock);
+    if (orderJournal.file == NULL) {
+        pthread_mutex_unlock(&journalLock);
+        return;
+    }
+    
+    journalWrite(orderJournal.file, type, payload, length);
+    orderJournal.records++;
+    
+    if (++orderJournal.pending >= JOURNAL_SYNC_BATCH) {
+        journalSyncLocked();
+    }
+    
+    /* Compact once most of the file is superseded status/stack/queue events.
+     * Callers may hold stack or queue locks here, so only flag it. */
+    int liveRecords = orderStore.count * 2 + deliveryCount + orderJournal.redemptions + 1;
+    if (orderJournal.records > JOURNAL_COMPACT_MIN && orderJournal.records > liveRecords * 2) {
+        orderJournal.compactDue = 1;
+    }
+    pthread_mutex_unlock(&journalLock);
+}
+
+void journalOrder(OrderHandle handle) {
+    unsigned char *buffer;
+    unsigned int length = encodeJournalOrder(orderAt(handle), &buffer);
+    journalAppend(JOURNAL_ORDER, buffer, length);
+    free(buffer);
+}
+
+void journalEvent(int type, const Order *order) {
+    JournalEvent event;
+    memset(&event, 0, sizeof(event));
+    event.orderId = order->orderId;
+    event.status = order->status;
+    event.time = order->statusTime;
+    journalAppend(type, &event, sizeof(event));
+}
+
+void journalRedemption(const char *code, const char *username, int customerUses, int totalUses) {
+    JournalRedemption record;
+    memset(&record, 0, sizeof(record));
+    strncpy(record.code, code, sizeof(record.code) - 1);
+    strncpy(record.username, username, sizeof(record.username) - 1);
+    record.customerUses = customerUses;
+    record.totalUses = totalUses;
+    journalAppend(JOURNAL_REDEMPTION, &record, sizeof(record));
+}
+
+void journalSync() {
+    pthread_mutex_lock(&journalLock);
+    journalSyncLocked();
+    pthread_mutex_unlock(&journalLock);
+}
+
+/* Records sit at any offset in the buffer, so each one is copied out before it is read */
+static void replayJournalRecord(unsigned int magic, int type, const unsigned char *payload, unsigned int length) {
+    if (type == JOURNAL_CHECKPOINT && length >= sizeof(JournalEvent)) {
+        JournalEvent checkpoint;
+        memcpy(&checkpoint, payload, sizeof(checkpoint));
+        if (checkpoint.orderId > currentOrderId) currentOrderId = checkpoint.orderId;
+        return;
+    }
+    
+    if (type == JOURNAL_ORDER && length >= sizeof(JournalOrder)) {
+        JournalOrder record;
+        memcpy(&record, payload, sizeof(record));
+        size_t itemSize = magic == JOURNAL_MAGIC_V1 ? sizeof(JournalItemV1) : sizeof(JournalItem);
+        if (record.itemCount < 0 || length < sizeof(JournalOrder) + itemSize * record.itemCount) return;
+        if (findOrderHandle(record.orderId) != -1) return;
+        
+        Order order;
+        memset(&order, 0, sizeof(order));
+        order.orderId = record.orderId;
+        order.customerId = internCustomer(record.username, record.address, record.phone);
+        order.deliveryFee = record.deliveryFee;
+        order.priority = record.priority;
+        order.status = record.status;
+        order.orderTime = (time_t)record.orderTime;
+        order.statusTime = (time_t)record.statusTime;
+        
+        OrderHandle handle = storeOrder(&order);
+        Order *stored = orderAt(handle);
+        const unsigned char *items = payload + sizeof(JournalOrder);
+        OrderLine *lines = allocOrderLines(stored, record.itemCount);
+        for (int i = 0; i < record.itemCount; i++) {
+            memcpy(&lines[i], items + itemSize * i, sizeof(OrderLine));  /* V1 starts with the same fields */
+        }
+        stored->subtotal = record.subtotal;
+        stored->discount = record.discount;
+        stored->tax = record.tax;
+        stored->total = record.total;
+        
+        indexAccountOrder(orderAccountId(stored), stored->orderId);  /* History is bulk-built after replay */
+        if (order.orderId >= currentOrderId) currentOrderId = order.orderId + 1;
+        if (order.orderTime > lastOrderTime) lastOrderTime = order.orderTime;
+        return;
+    }
+    
+    if (type == JOURNAL_REDEMPTION && length >= sizeof(JournalRedemption)) {
+        JournalRedemption record;
+        memcpy(&record, payload, sizeof(record));
+        record.code[sizeof(record.code) - 1] = '\0';
+        record.username[sizeof(record.username) - 1] = '\0';
+        int slot = findPromoSlot(record.code);
+        if (slot == -1) return;
+        if (record.totalUses > 0) raisePromoUse(&promoAt(slot)->uses, record.totalUses);
+        if (record.customerUses > 0 && record.username[0] != '\0') {
+            raisePromoUse(redemptionCounter(slot, record.username), record.customerUses);
+        }
+        return;
+    }
+    
+    if (length < sizeof(JournalEvent)) return;
+    JournalEvent event;
+    memcpy(&event, payload, sizeof(event));
+    OrderHandle handle = findOrderHandle(event.orderId);
+    if (handle == -1) return;
+    
+    switch (type) {
+        case JOURNAL_STATUS:
+            orderAt(handle)->status = event.status;
+            orderAt(handle)->statusTime = (time_t)event.time;
+            break;
+        case JOURNAL_PUSH:
+            stackPushHandle(handle, 0);
+            break;
+        case JOURNAL_POP:
+            stackRemoveHandle(handle);
+            break;
+        case JOURNAL_ENQUEUE:
+            deliveryAppend(handle, 0);
+            break;
+        case JOURNAL_DEQUEUE:
+            /* Batches take orders from mid-queue, so remove this very order */
+            deliveryRemove(handle, 0);
+            break;
+    }
+}
+
+void replayOrderJournal() {
+    FILE *file = fopen(JOURNAL_FILE, "rb");
+    if (file == NULL) return;
+    
+    /* Read the whole journal in one go and decode it in memory */
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = (unsigned char*)xmalloc(size > 0 ? size : 1);
+    size_t bytes = fread(data, 1, size, file);
+    fclose(file);
+    
+    size_t offset = 0;
+    int records = 0;
+    while (offset + sizeof(JournalHeader) <= bytes) {
+        JournalHeader header;
+        memcpy(&header, data + offset, sizeof(header));
+        if ((header.magic != JOURNAL_MAGIC && header.magic != JOURNAL_MAGIC_V1) ||
+            header.length > bytes - offset - sizeof(header)) break;
+        
+        const unsigned char *payload = data + offset + sizeof(header);
+        if (crc32(payload, header.length) != header.crc) break;
+        
+        replayJournalRecord(header.magic, header.type, payload, header.length);
+        offset += sizeof(header) + header.length;
+        records++;
+    }
+    free(data);
+    rebuildOrderHistory();
+    rebuildSalesAnalytics();
+    
+    orderJournal.records = records;
+    if (offset != bytes) {
+        /* Torn or corrupt tail from a crash: keep what was valid */
+        notify("⚠ Order journal damaged after %d records, recovering...\n", records);
+        orderJournal.records = -1;
+    }
+    if (records > 0) {
+        notify("✓ Recovered %d orders from journal\n", orderStore.count);
+    }
+}
+
+void compactOrderJournal() {
+    /* Wait out in-flight checkouts, freeze the stack and queue, then the journal */
+    pthread_rwlock_wrlock(&checkoutGate);
+    pthread_mutex_lock(&orderStackLock);
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        pthread_mutex_lock(&deliveryBuckets[b].lock);
+    }
+    pthread_mutex_lock(&journalLock);
+    
+    FILE *file = fopen(JOURNAL_TEMP_FILE, "wb");
+    if (file == NULL) {
+        orderJournal.compactDue = 0;
+        goto unlock;
+    }
+    
+    int records = 0;
+    JournalEvent checkpoint;
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    checkpoint.orderId = currentOrderId;
+    checkpoint.time = time(NULL);
+    journalWrite(file, JOURNAL_CHECKPOINT, &checkpoint, sizeof(checkpoint));
+    records++;
+    
+    /* Every order with its current status */
+    for (OrderHandle handle = 0; handle < orderStore.count; handle++) {
+        unsigned char *buffer;
+        unsigned int length = encodeJournalOrder(orderAt(handle), &buffer);
+        journalWrite(file, JOURNAL_ORDER, buffer, length);
+        free(buffer);
+        records++;
+    }
+    
+    /* Stack contents bottom to top */
+    int stackSize = 0;
+    for (OrderStack *current = orderStackTop; current != NULL; current = current->next) {
+        stackSize++;
+    }
+    OrderHandle *stackHandles = (OrderHandle*)xmalloc(sizeof(OrderHandle) * (stackSize + 1));
+    int i = stackSize;
+    for (OrderStack *current = orderStackTop; current != NULL; current = current->next) {
+        stackHandles[--i] = current->handle;
+    }
+    JournalEvent event;
+    memset(&event, 0, sizeof(event));
+    for (i = 0; i < stackSize; i++) {
+        event.orderId = orderAt(stackHandles[i])->orderId;
+        journalWrite(file, JOURNAL_PUSH, &event, sizeof(event));
+        records++;
+    }
+    free(stackHandles);
+    
+    /* Delivery queue in FIFO order per priority */
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        for (Delivery *current = deliveryBuckets[b].front; current != NULL; current = current->next) {
+            event.orderId = orderAt(current->handle)->orderId;
+            journalWrite(file, JOURNAL_ENQUEUE, &event, sizeof(event));
+            records++;
+        }
+    }
+    
+    /* Promo usage since the last save, code-wide then per customer */
+    int redemptions = 0;
+    JournalRedemption redemption;
+    pthread_rwlock_rdlock(&promoTable.lock);
+    for (int slot = 0; slot < promoTable.count; slot++) {
+        PromoCode *promo = promoAt(slot);
+        if (atomic_load(&promo->uses) == 0) continue;
+        memset(&redemption, 0, sizeof(redemption));
+        strcpy(redemption.code, promo->code);
+        redemption.customerUses = -1;
+        redemption.totalUses = atomic_load(&promo->uses);
+        journalWrite(file, JOURNAL_REDEMPTION, &redemption, sizeof(redemption));
+        redemptions++;
+    }
+    for (int r = 0; r < PROMO_REDEMPTION_STRIPES; r++) {
+        pthread_mutex_lock(&redemptionStripes[r].lock);
+        for (int b = 0; b < redemptionStripes[r].bucketCount; b++) {
+            for (PromoRedemption *node = redemptionStripes[r].buckets[b]; node != NULL; node = node->next) {
+                if (atomic_load(&node->count) == 0) continue;
+                memset(&redemption, 0, sizeof(redemption));
+                strcpy(redemption.code, promoAt(node->promo)->code);
+                strcpy(redemption.username, node->username);
+                redemption.customerUses = atomic_load(&node->count);
+                redemption.totalUses = -1;
+                journalWrite(file, JOURNAL_REDEMPTION, &redemption, sizeof(redemption));
+                redemptions++;
+            }
+        }
+        pthread_mutex_unlock(&redemptionStripes[r].lock);
+    }
+    pthread_rwlock_unlock(&promoTable.lock);
+    records += redemptions;
+    
+    fflush(file);
+    syncFile(fileno(file));
+    fclose(file);
+    
+    /* Swap the compacted journal in and keep appending to it */
+    if (orderJournal.file != NULL) {
+        fclose(orderJournal.file);
+    }
+#ifdef _WIN32
+    remove(JOURNAL_FILE);
+#endif
+    rename(JOURNAL_TEMP_FILE, JOURNAL_FILE);
+    orderJournal.file = fopen(JOURNAL_FILE, "ab");
+    orderJournal.records = records;
+    orderJournal.redemptions = redemptions;
+    orderJournal.pending = 0;
+    orderJournal.compactDue = 0;
+    
+unlock:
+    pthread_mutex_unlock(&journalLock);
+    for (int b = PRIORITY_LEVELS - 1; b >= 0; b--) {
+        pthread_mutex_unlock(&deliveryBuckets[b].lock);
+    }
+    pthread_mutex_unlock(&orderStackLock);
+    pthread_rwlock_unlock(&checkoutGate);
+}
+
+void compactOrderJournalIfDue() {
+    if (orderJournal.compactDue) {
+        compactOrderJournal();
+    }
+}
+
+void openOrderJournal() {
+    /* A damaged tail is dropped by rewriting the journal from memory */
+    if (orderJournal.records < 0 || orderJournal.records > JOURNAL_COMPACT_MIN) {
+        compactOrderJournal();
+        return;
+    }
+    orderJournal.file = fopen(JOURNAL_FILE, "ab");
+}
+
+void closeOrderJournal() {
+    if (orderJournal.file == NULL) return;
+    
+    journalSync();
+    fclose(orderJournal.file);
+    orderJournal.file = NULL;
+}
+
+/* =============================== BINARY SNAPSHOT =============================== */
+unsigned int stringTableAdd(StringTable *table, const char *str) {
+    unsigned int length = (unsigned int)strlen(str) + 1;
+    if (table->size + length > table->capacity) {
+        while (table->size + length > table->capacity) {
+            table->capacity = table->capacity ? table->capacity * 2 : 4096;
+        }
+        table->data = (char*)xrealloc(table->data, table->capacity);
+    }
+    
+    unsigned int offset = table->size;
+    memcpy(table->data + offset, str, length);
+    table->size += length;
+    return offset;
+}
+
+static unsigned int snapshotAlign(size_t offset) {
+    return (unsigned int)((offset + SNAPSHOT_ALIGN - 1) & ~(size_t)(SNAPSHOT_ALIGN - 1));
+}
+
+/* Zero-pads up to the section's offset, then writes its records */
+static int snapshotWriteSection(FILE *file, unsigned int offset, const void *records, size_t size, size_t count) {
+    static const unsigned char padding[SNAPSHOT_ALIGN] = {0};
+    long at = ftell(file);
+    if (at < 0 || (unsigned long)at > offset || offset - (unsigned long)at >= SNAPSHOT_ALIGN) return 0;
+    size_t pad = offset - (size_t)at;
+    return fwrite(padding, 1, pad, file) == pad && fwrite(records, size, count, file) == count;
+}
+
+int saveSnapshot() {
+    StringTable strings = {0};
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.nextMenuId = menuCatalog.nextId;
+    
+    /* Menu in catalog slot order */
+    header.menuCount = menuCatalog.count;
+    SnapshotMenuItem *menu = (SnapshotMenuItem*)xmalloc(sizeof(SnapshotMenuItem) * (header.menuCount + 1));
+    for (int slot = 0; slot < menuCatalog.count; slot++) {
+        FoodItem *item = menuItemAt(slot);
+        menu[slot].id = item->id;
+        menu[slot].price = item->price;
+        menu[slot].stock = item->stock;
+        menu[slot].name = stringTableAdd(&strings, menuItemName(item));
+        menu[slot].category = stringTableAdd(&strings, menuItemCategory(item));
+    }
+    
+    /* Users in sorted order, so loading can build a balanced tree directly */
+    unsigned int userCapacity = 1024;
+    SnapshotUser *users = (SnapshotUser*)xmalloc(sizeof(SnapshotUser) * userCapacity);
+    User *stack[USER_TREE_MAX_DEPTH];
+    int top = 0;
+    User *current = userRoot;
+    while (current != NULL || top > 0) {
+        while (current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        current = stack[--top];
+        if (header.userCount == userCapacity) {
+            userCapacity *= 2;
+            users = (SnapshotUser*)xrealloc(users, sizeof(SnapshotUser) * userCapacity);
+        }
+        SnapshotUser *record = &users[header.userCount++];
+        record->username = stringTableAdd(&strings, current->username);
+        record->credential = stringTableAdd(&strings, current->credential);
+        record->address = stringTableAdd(&strings, current->address);
+        record->phone = stringTableAdd(&strings, current->phone);
+        record->loyaltyPoints = current->loyaltyPoints;
+        current = current->right;
+    }
+    
+    /* Promo codes in slot order, so redemptions can refer to them by index */
+    header.promoCount = promoTable.count;
+    SnapshotPromo *promos = (SnapshotPromo*)xcalloc(header.promoCount + 1, sizeof(SnapshotPromo));
+    for (int slot = 0; slot < promoTable.count; slot++) {
+        PromoCode *promo = promoAt(slot);
+        promos[slot].code = stringTableAdd(&strings, promo->code);
+        promos[slot].discount = promo->discount;
+        promos[slot].validFrom = promo->validFrom;
+        promos[slot].validUntil = promo->validUntil;
+        promos[slot].maxUses = promo->maxUses;
+        promos[slot].maxUsesPerCustomer = promo->maxUsesPerCustomer;
+        promos[slot].uses = atomic_load(&promo->uses);
+    }
+    
+    for (int i = 0; i < PROMO_REDEMPTION_STRIPES; i++) {
+        header.redemptionCount += redemptionStripes[i].count;
+    }
+    SnapshotRedemption *redemptions = (SnapshotRedemption*)xmalloc(sizeof(SnapshotRedemption) *
+                                                                   (header.redemptionCount + 1));
+    unsigned int r = 0;
+    for (int i = 0; i < PROMO_REDEMPTION_STRIPES; i++) {
+        for (int b = 0; b < redemptionStripes[i].bucketCount; b++) {
+            for (PromoRedemption *node = redemptionStripes[i].buckets[b]; node != NULL; node = node->next, r++) {
+                redemptions[r].promo = node->promo;
+                redemptions[r].username = stringTableAdd(&strings, node->username);
+                redemptions[r].count = atomic_load(&node->count);
+            }
+        }
+    }
+    
+    header.menuOffset = snapshotAlign(sizeof(SnapshotHeader));
+    header.userOffset = snapshotAlign(header.menuOffset + sizeof(SnapshotMenuItem) * header.menuCount);
+    header.promoOffset = snapshotAlign(header.userOffset + sizeof(SnapshotUser) * header.userCount);
+    header.redemptionOffset = snapshotAlign(header.promoOffset + sizeof(SnapshotPromo) * header.promoCount);
+    header.stringOffset = snapshotAlign(header.redemptionOffset + sizeof(SnapshotRedemption) * header.redemptionCount);
+    header.stringSize = strings.size;
+    
+    int ok = 0;
+    FILE *file = fopen(SNAPSHOT_TEMP_FILE, "wb");
+    if (file != NULL) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1
+          && snapshotWriteSection(file, header.menuOffset, menu, sizeof(SnapshotMenuItem), header.menuCount)
+          && snapshotWriteSection(file, header.userOffset, users, sizeof(SnapshotUser), header.userCount)
+          && snapshotWriteSection(file, header.promoOffset, promos, sizeof(SnapshotPromo), header.promoCount)
+          && snapshotWriteSection(file, header.redemptionOffset, redemptions, sizeof(SnapshotRedemption),
+                                  header.redemptionCount)
+          && snapshotWriteSection(file, header.stringOffset, strings.data, 1, strings.size);
+        ok = (fclose(file) == 0) && ok;
+        if (ok) {
+#ifdef _WIN32
+            remove(SNAPSHOT_FILE);
+#endif
+            ok = rename(SNAPSHOT_TEMP_FILE, SNAPSHOT_FILE) == 0;
+        }
+    }
+    
+    free(menu);
+    free(users);
+    free(promos);
+    free(redemptions);
+    free(strings.data);
+    return ok;
+}
+
+/* Builds a perfectly balanced user tree from sorted records in O(n) */
+static User* buildUserTree(User *nodes, int lo, int hi) {
+    if (lo > hi) return NULL;
+    
+    int mid = lo + (hi - lo) / 2;
+    User *root = &nodes[mid];
+    root->left = buildUserTree(nodes, lo, mid - 1);
+    root->right = buildUserTree(nodes, mid + 1, hi);
+    root->height = 1 + maxInt(userHeight(root->left), userHeight(root->right));
+    return root;
+}
+
+static int snapshotStringValid(const SnapshotHeader *header, const char *strings, unsigned int offset) {
+    return offset < header->stringSize && memchr(strings + offset, '\0', header->stringSize - offset) != NULL;
+}
+
+int loadSnapshot() {
+    const unsigned char *data = NULL;
+    size_t size = 0;
+    
+#ifdef _WIN32
+    FILE *file = fopen(SNAPSHOT_FILE, "rb");
+    if (file == NULL) return 0;
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *buffer = (unsigned char*)xmalloc(size > 0 ? size : 1);
+    size = fread(buffer, 1, size, file);
+    fclose(file);
+    data = buffer;
+#else
+    int fd = open(SNAPSHOT_FILE, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        return 0;
+    }
+    size = info.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return 0;
+    data = (const unsigned char*)mapping;
+#endif
+    
+    /* Validate the header and every section bound before touching records */
+    const SnapshotHeader *header = (const SnapshotHeader*)data;
+    int valid = size >= sizeof(SnapshotHeader)
+        && header->magic == SNAPSHOT_MAGIC
+        && header->version == SNAPSHOT_VERSION
+        && header->menuOffset == snapshotAlign(sizeof(SnapshotHeader))
+        && header->userOffset == snapshotAlign(header->menuOffset + sizeof(SnapshotMenuItem) * (size_t)header->menuCount)
+        && header->promoOffset == snapshotAlign(header->userOffset + sizeof(SnapshotUser) * (size_t)header->userCount)
+        && header->redemptionOffset == snapshotAlign(header->promoOffset
+                                                     + sizeof(SnapshotPromo) * (size_t)header->promoCount)
+        && header->stringOffset == snapshotAlign(header->redemptionOffset
+                                                 + sizeof(SnapshotRedemption) * (size_t)header->redemptionCount)
+        && (size_t)header->stringOffset + header->stringSize <= size;
+    
+    if (valid) {
+        const SnapshotMenuItem *menu = (const SnapshotMenuItem*)(data + header->menuOffset);
+        const SnapshotUser *users = (const SnapshotUser*)(data + header->userOffset);
+        const SnapshotPromo *promos = (const SnapshotPromo*)(data + header->promoOffset);
+        const SnapshotRedemption *redemptions = (const SnapshotRedemption*)(data + header->redemptionOffset);
+        const char *strings = (const char*)(data + header->stringOffset);
+        
+        for (unsigned int i = 0; valid && i < header->menuCount; i++) {
+            valid = snapshotStringValid(header, strings, menu[i].name)
+                 && snapshotStringValid(header, strings, menu[i].category);
+        }
+        for (unsigned int i = 0; valid && i < header->userCount; i++) {
+            valid = snapshotStringValid(header, strings, users[i].username)
+                 && snapshotStringValid(header, strings, users[i].credential)
+                 && snapshotStringValid(header, strings, users[i].address)
+                 && snapshotStringValid(header, strings, users[i].phone)
+                 && strlen(strings + users[i].username) < MAX_NAME
+                 && strlen(strings + users[i].credential) < MAX_PASSWORD_HASH
+                 && strlen(strings + users[i].address) < MAX_ADDR
+                 && strlen(strings + users[i].phone) < MAX_PHONE
+                 && (i == 0 || strcmp(strings + users[i - 1].username, strings + users[i].username) < 0);
+        }
+        for (unsigned int i = 0; valid && i < header->promoCount; i++) {
+            valid = snapshotStringValid(header, strings, promos[i].code);
+        }
+        for (unsigned int i = 0; valid && i < header->redemptionCount; i++) {
+            valid = redemptions[i].promo < header->promoCount
+                 && snapshotStringValid(header, strings, redemptions[i].username)
+                 && strlen(strings + redemptions[i].username) < MAX_NAME;
+        }
+        
+        if (valid) {
+            for (unsigned int i = 0; i < header->menuCount; i++) {
+                createFoodItem(menu[i].id, strings + menu[i].name, strings + menu[i].category,
+                               menu[i].price, menu[i].stock);
+            }
+            menuCatalog.nextId = header->nextMenuId;
+            
+            /* Users are stored sorted: one allocation, balanced tree in O(n) */
+            if (header->userCount > 0) {
+                User *nodes = (User*)xmalloc(sizeof(User) * header->userCount);
+                for (unsigned int i = 0; i < header->userCount; i++) {
+                    User *user = &nodes[i];
+                    strcpy(user->username, strings + users[i].username);
+                    strcpy(user->credential, strings + users[i].credential);
+                    strcpy(user->address, strings + users[i].address);
+                    strcpy(user->phone, strings + users[i].phone);
+                    user->loyaltyPoints = users[i].loyaltyPoints;
+                }
+                userRoot = buildUserTree(nodes, 0, (int)header->userCount - 1);
+                userNodeBlock = nodes;
+                userNodeBlockCount = header->userCount;
+            }
+            
+            reservePromoCapacity(header->promoCount);
+            for (unsigned int i = 0; i < header->promoCount; i++) {
+                PromoCode *promo = insertPromoCode(strings + promos[i].code, promos[i].discount,
+                                                   (time_t)promos[i].validFrom, (time_t)promos[i].validUntil,
+                                                   promos[i].maxUses, promos[i].maxUsesPerCustomer);
+                if (promo != NULL) atomic_store(&promo->uses, promos[i].uses);
+            }
+            for (unsigned int i = 0; i < header->redemptionCount; i++) {
+                atomic_store(redemptionCounter(redemptions[i].promo, strings + redemptions[i].username),
+                             redemptions[i].count);
+            }
+        }
+    }
+    
+#ifdef _WIN32
+    free(buffer);
+#else
+    munmap(mapping, size);
+#endif
+    return valid;
+}
+
+/* =============================== FILE HANDLING =============================== */
+void saveUsersInorder(User *root, FILE *file) {
+    User *stack[USER_TREE_MAX_DEPTH];
+    int top = 0;
+    User *current = root;
+    
+    while (current != NULL || top > 0) {
+        while (current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        current = stack[--top];
+        fprintf(file, "%s,%s,%s,%s,%d\n",
+                current->username, current->credential, current->address,
+                current->phone, current->loyaltyPoints);
+        current = current->right;
+    }
+}
+
+void exportTextData() {
     /* Save Menu */
     FILE *menuFile = fopen("menu.dat", "w");
-    FoodItem *menuCurrent = menuHead;
-    while (menuCurrent != NULL) {
+    for (int slot = 0; slot < menuCatalog.count; slot++) {
+        FoodItem *menuCurrent = menuItemAt(slot);
         fprintf(menuFile, "%d,%s,%s,%.2f,%d\n", 
-                menuCurrent->id, menuCurrent->name, menuCurrent->category,
+                menuCurrent->id, menuItemName(menuCurrent), menuItemCategory(menuCurrent),
                 menuCurrent->price, menuCurrent->stock);
-        menuCurrent = menuCurrent->next;
     }
     fclose(menuFile);
     
@@ -1003,19 +5279,29 @@ void saveData() {
     saveUsersInorder(userRoot, userFile);
     fclose(userFile);
     
-    /* Save Promo Codes */
+    /* Save Promo Codes, then who has redeemed the per-customer limited ones */
     FILE *promoFile = fopen("promo.dat", "w");
-    PromoCode *promoCurrent = promoHead;
-    while (promoCurrent != NULL) {
-        fprintf(promoFile, "%s,%.2f\n", promoCurrent->code, promoCurrent->discount);
-        promoCurrent = promoCurrent->next;
+    for (int slot = 0; slot < promoTable.count; slot++) {
+        PromoCode *promo = promoAt(slot);
+        fprintf(promoFile, "%s,%.2f,%lld,%lld,%d,%d,%d\n", promo->code, promo->discount,
+                (long long)promo->validFrom, (long long)promo->validUntil,
+                promo->maxUses, promo->maxUsesPerCustomer, atomic_load(&promo->uses));
     }
     fclose(promoFile);
     
-    printf("✓ All data saved successfully!\n");
+    FILE *redemptionFile = fopen("redemptions.dat", "w");
+    for (int i = 0; i < PROMO_REDEMPTION_STRIPES; i++) {
+        for (int b = 0; b < redemptionStripes[i].bucketCount; b++) {
+            for (PromoRedemption *node = redemptionStripes[i].buckets[b]; node != NULL; node = node->next) {
+                fprintf(redemptionFile, "%s,%s,%d\n", promoAt(node->promo)->code, node->username,
+                        atomic_load(&node->count));
+            }
+        }
+    }
+    fclose(redemptionFile);
 }
 
-void loadData() {
+void importTextData() {
     /* Load Menu */
     FILE *menuFile = fopen("menu.dat", "r");
     if (menuFile) {
@@ -1023,7 +5309,9 @@ void loadData() {
         char name[80], category[30];
         float price;
         while (fscanf(menuFile, "%d,%[^,],%[^,],%f,%d\n", &id, name, category, &price, &stock) == 5) {
-            addToMenu(name, category, price, stock);
+            if (findMenuItem(id) != NULL) continue;
+            createFoodItem(id, name, category, price, stock);
+            if (id >= menuCatalog.nextId) menuCatalog.nextId = id + 1;
         }
         fclose(menuFile);
     }
@@ -1031,53 +5319,95 @@ void loadData() {
     /* Load Users */
     FILE *userFile = fopen("users.dat", "r");
     if (userFile) {
-        char username[MAX_NAME], password[MAX_PASS], address[MAX_ADDR], phone[MAX_PHONE];
+        char username[MAX_NAME], credential[MAX_PASSWORD_HASH], address[MAX_ADDR], phone[MAX_PHONE];
         int loyaltyPoints;
-        while (fscanf(userFile, "%[^,],%[^,],%[^,],%[^,],%d\n", 
-                     username, password, address, phone, &loyaltyPoints) == 5) {
-            User *newUser = createUser(username, password, address, phone);
+        while (fscanf(userFile, "%49[^,],%111[^,],%99[^,],%14[^,],%d\n", 
+                     username, credential, address, phone, &loyaltyPoints) == 5) {
+            User *newUser = createUser(username, credential, address, phone);
             newUser->loyaltyPoints = loyaltyPoints;
             userRoot = insertUser(userRoot, newUser);
         }
         fclose(userFile);
     }
     
-    /* Load Promo Codes */
+    /* Load Promo Codes; older files carry only CODE,PERCENT */
     FILE *promoFile = fopen("promo.dat", "r");
     if (promoFile) {
-        char code[20];
-        float discount;
-        while (fscanf(promoFile, "%[^,],%f\n", code, &discount) == 2) {
-            addPromoCode(code, discount);
-        }
+        importPromoCodes(promoFile);
         fclose(promoFile);
     }
     
+    FILE *redemptionFile = fopen("redemptions.dat", "r");
+    if (redemptionFile) {
+        char code[20], username[MAX_NAME];
+        int count;
+        while (fscanf(redemptionFile, "%19[^,],%49[^,],%d\n", code, username, &count) == 3) {
+            int slot = findPromoSlot(code);
+            if (slot != -1) atomic_store(redemptionCounter(slot, username), count);
+        }
+        fclose(redemptionFile);
+    }
+}
+
+void saveData() {
+    /* A fresh run must leave the data directory exactly as it found it */
+    if (freshState) return;
+    
+    /* Text files stay the human-readable import/export format */
+    exportTextData();
+    
+    /* Binary snapshot is what the next startup loads */
+    if (!saveSnapshot()) {
+        notify("✗ Could not write %s\n", SNAPSHOT_FILE);
+    }
+    
+    /* Orders are persisted continuously by the journal */
+    journalSync();
+    
+    notify("✓ All data saved successfully!\n");
+}
+
+void loadData() {
+    /* Prefer the binary snapshot; fall back to importing the text files */
+    if (!freshState && !loadSnapshot()) {
+        importTextData();
+    }
+    
     /* Load Default Users if none */
     if (userRoot == NULL) {
-        User *admin = createUser("admin", "admin123", "Admin Office", "1234567890");
+        char credential[MAX_PASSWORD_HASH];
+        hashPassword("admin123", passwordCost, credential);
+        User *admin = createUser("admin", credential, "Admin Office", "1234567890");
         admin->loyaltyPoints = 1000;
         userRoot = insertUser(userRoot, admin);
         
-        User *user = createUser("user", "user123", "123 Main St", "9876543210");
+        hashPassword("user123", passwordCost, credential);
+        User *user = createUser("user", credential, "123 Main St", "9876543210");
         userRoot = insertUser(userRoot, user);
         
         /* Add some promo codes */
-        addPromoCode("WELCOME10", 10);
-        addPromoCode("SAVE20", 20);
-        addPromoCode("FIRSTORDER", 15);
+        addPromoCode("WELCOME10", 10, 0, 0, 0);
+        addPromoCode("SAVE20", 20, 0, 0, 0);
+        addPromoCode("FIRSTORDER", 15, 0, 0, 1);
     }
 }
 
 /* =============================== CORE FUNCTIONS =============================== */
 void initializeSystem() {
-    printf("Initializing Food Delivery System...\n");
+    notify("Initializing Food Delivery System...\n");
+    resetEtaEngine();
     
     /* Load existing data */
     loadData();
     
+    /* Rebuild orders, stack, queue and history from the journal */
+    if (!freshState) {
+        replayOrderJournal();
+        openOrderJournal();
+    }
+    
     /* Add sample menu items if empty */
-    if (menuHead == NULL) {
+    if (menuCatalog.count == 0) {
         addToMenu("Margherita Pizza", "Pizza", 12.99, 50);
         addToMenu("Pepperoni Pizza", "Pizza", 14.99, 40);
         addToMenu("Veg Supreme Pizza", "Pizza", 13.99, 30);
@@ -1095,33 +5425,164 @@ void initializeSystem() {
         addToMenu("Iced Tea", "Drinks", 2.49, 120);
     }
     
-    printf("✓ System initialized successfully!\n");
+    notify("✓ System initialized successfully!\n");
 }
 
-void checkout(const char *username, const char *address, const char *phone) {
-    if (cartHead == NULL) {
-        printf("Your cart is empty! Add items first.\n");
-        return;
+/* Releases every in-memory structure and returns to an empty system */
+void resetSystemState() {
+    
+    for (int b = 0; b < menuCatalog.blockCount; b++) {
+        free(menuCatalog.blocks[b]);
     }
+    free(menuCatalog.blocks);
+    idIndexFree(&menuCatalog.idIndex);
+    free(menuCatalog.categories);
+    free(menuCatalog.categoryBuckets);
+    free(menuCatalog.nameOrder);
+    for (int p = 0; p < menuCatalog.postingCount; p++) {
+        free(menuCatalog.postings[p].slots);
+    }
+    free(menuCatalog.postings);
+    idIndexFree(&menuCatalog.trigramIndex);
+    memset(&menuCatalog, 0, sizeof(menuCatalog));
     
-    printHeader("CHECKOUT");
+    /* Users: iterative post-order free, skipping the snapshot's bulk block */
+    User *stack[USER_TREE_MAX_DEPTH];
+    int top = 0;
+    if (userRoot != NULL) stack[top++] = userRoot;
+    while (top > 0) {
+        User *user = stack[--top];
+        if (user->left != NULL) stack[top++] = user->left;
+        if (user->right != NULL) stack[top++] = user->right;
+        if (user < userNodeBlock || user >= userNodeBlock + userNodeBlockCount) {
+            free(user);
+        }
+    }
+    free(userNodeBlock);
+    userRoot = NULL;
+    userNodeBlock = NULL;
+    userNodeBlockCount = 0;
     
-    /* Calculate subtotal from cart */
-    float subtotal = calculateCartTotal();
-    printf("Subtotal: $%.2f\n", subtotal);
+    releasePromoCodes();
+    releaseSessionTokens();
     
-    /* Apply promo code */
-    char promoCode[20];
-    printf("Enter promo code (or 'skip'): ");
-    scanf("%s", promoCode);
+    /* Stack, queue, history, order lines and carts all live in slab pools */
+    orderStackTop = orderStackBottom = NULL;
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        deliveryBuckets[b].front = deliveryBuckets[b].rear = NULL;
+        deliveryBuckets[b].depth = 0;
+    }
+    deliveryCount = 0;
+    for (int b = 0; b < PRIORITY_LEVELS; b++) {
+        free(deliveryBuckets[b].departed);
+        deliveryBuckets[b].departed = NULL;
+        deliveryBuckets[b].tickets = deliveryBuckets[b].capacity = 0;
+    }
+    releaseDeliveryZones();
+    resetEtaEngine();
+    releaseOrderHistory();
+    releaseSalesAnalytics();
+    releaseCartPool();
+    for (int i = 0; i < SLAB_POOL_COUNT; i++) {
+        slabRelease(slabPools[i]);
+    }
+    
+    for (int b = 0; b < orderStore.blockCount; b++) {
+        free(orderStore.blocks[b]);
+    }
+    releaseOrderLines();
+    idIndexFree(&orderStore.idIndex);
+    orderStore.blockCount = 0;
+    orderStore.count = 0;
+    releaseCustomerTable();
+    
+    currentOrderId = 1000;
+    lastOrderTime = 0;
+}
+
+Order* placeOrder(Session *session, const char *promoCode, int priority) {
+    Cart *cart = session->cart;
+    User *user = session->user;
+    
+    if (cart->head == NULL) {
+        notify("Your cart is empty! Add items first.\n");
+        return NULL;
+    }
+    
+    /* Reserve every line atomically; on any shortage undo and refuse */
+    for (CartItem *line = cart->head; line != NULL; line = line->next) {
+        FoodItem *item = findMenuItem(line->itemId);
+        if (item == NULL || !reserveStock(item, line->quantity)) {
+            for (CartItem *undo = cart->head; undo != line; undo = undo->next) {
+                releaseStock(findMenuItem(undo->itemId), undo->quantity);
+            }
+            notify("✗ %s is no longer available in that quantity.\n", line->itemName);
+            return NULL;
+        }
+    }
+    
+    /* Calculate subtotal from cart */
+    float subtotal = calculateCartTotal(cart);
     
+    /* Apply promo code; limits are enforced atomically, so checkouts redeem concurrently */
     float discount = 0;
     float total = subtotal;
-    if (strcmp(promoCode, "skip") != 0) {
-        total = applyPromoCode(promoCode, subtotal);
+    if (promoCode != NULL && strcmp(promoCode, "skip") != 0) {
+        total = redeemPromoCode(promoCode, user->username, subtotal);
         discount = subtotal - total;
     }
     
+    /* Create order in the canonical store; compaction waits until it is complete */
+    pthread_rwlock_rdlock(&checkoutGate);
+    Order *newOrder = createOrder(internCustomer(user->username, user->address, user->phone), priority);
+    OrderHandle handle = findOrderHandle(newOrder->orderId);
+    
+    /* Cart lines go straight into one contiguous run of the line arena */
+    OrderLine *line = allocOrderLines(newOrder, cart->lineCount);
+    for (CartItem *cartCurrent = cart->head; cartCurrent != NULL; cartCurrent = cartCurrent->next, line++) {
+        line->itemId = cartCurrent->itemId;
+        line->quantity = cartCurrent->quantity;
+        line->price = cartCurrent->price;
+        newOrder->subtotal += cartCurrent->price * cartCurrent->quantity;
+    }
+    
+    newOrder->discount = discount;
+    newOrder->tax = (total + newOrder->deliveryFee) * 0.08;
+    newOrder->total = total + newOrder->deliveryFee + newOrder->tax;
+    
+    /* Stack, queue and history all reference the same order */
+    journalOrder(handle);
+    pushOrder(handle);
+    enqueueDelivery(handle);
+    appendOrderHistory(handle);
+    indexAccountOrder(orderAccountId(newOrder), newOrder->orderId);
+    recordSale(newOrder);
+    pthread_rwlock_unlock(&checkoutGate);
+    
+    /* Update loyalty points */
+    addLoyaltyPoints(user->username, newOrder->total);
+    
+    /* Clear cart */
+    clearCart(cart);
+    
+    compactOrderJournalIfDue();
+    return newOrder;
+}
+
+void checkout(Session *session) {
+    if (session->cart->head == NULL) {
+        printf("Your cart is empty! Add items first.\n");
+        return;
+    }
+    
+    printHeader("CHECKOUT");
+    printf("Subtotal: $%.2f\n", calculateCartTotal(session->cart));
+    
+    /* Apply promo code */
+    char promoCode[20];
+    printf("Enter promo code (or 'skip'): ");
+    scanf("%19s", promoCode);
+    
     /* Get delivery priority */
     int priority;
     printf("\nSelect delivery priority:\n");
@@ -1131,63 +5592,25 @@ void checkout(const char *username, const char *address, const char *phone) {
     printf("4. Express (30-60 minutes)\n");
     printf("Choice: ");
     scanf("%d", &priority);
+    recordCommand("checkout %s %d", promoCode, priority);
     
-    /* Create order */
-    Order newOrder;
-    newOrder.orderId = currentOrderId++;
-    strcpy(newOrder.username, username);
-    strcpy(newOrder.address, address);
-    strcpy(newOrder.phone, phone);
-    newOrder.items = NULL;
-    newOrder.itemCount = 0;
-    newOrder.subtotal = subtotal;
-    newOrder.discount = discount;
-    newOrder.deliveryFee = 2.99;
-    newOrder.tax = (total + 2.99) * 0.08;
-    newOrder.total = total + 2.99 + newOrder.tax;
-    newOrder.priority = priority;
-    newOrder.status = 0; /* Pending */
-    newOrder.orderTime = time(NULL);
-    newOrder.statusTime = time(NULL);
-    newOrder.next = NULL;
-    
-    /* Add cart items to order */
-    CartItem *cartCurrent = cartHead;
-    while (cartCurrent != NULL) {
-        addItemToOrder(&newOrder, cartCurrent->itemId, cartCurrent->itemName, 
-                       cartCurrent->quantity, cartCurrent->price);
-        updateStock(cartCurrent->itemId, cartCurrent->quantity);
-        cartCurrent = cartCurrent->next;
+    Order *newOrder = placeOrder(session, promoCode, priority);
+    if (newOrder == NULL) {
+        printf("Checkout cancelled, please review your cart.\n");
+        return;
     }
     
-    /* Push to order stack */
-    pushOrder(newOrder);
-    
-    /* Add to delivery queue */
-    enqueueDelivery(newOrder);
-    
-    /* Add to order history (AVL tree) */
-    historyRoot = insertOrderHistory(historyRoot, newOrder);
-    
-    /* Update loyalty points */
-    addLoyaltyPoints(username, newOrder.total);
-    
-    /* Clear cart */
-    clearCart();
-    
-    printf("\n✓ Order #%d confirmed!\n", newOrder.orderId);
+    printf("\n✓ Order #%d confirmed!\n", newOrder->orderId);
     printf("\nOrder Summary:\n");
     printf("────────────────────────────────────────────────────────────\n");
-    displayOrderDetails(&newOrder);
+    displayOrderDetails(newOrder);
     printf("────────────────────────────────────────────────────────────\n");
 }
 
-void userDashboard(const char *username) {
-    User *user = searchUser(userRoot, username);
-    if (user == NULL) {
-        printf("User not found!\n");
-        return;
-    }
+/* Returns 1 on logout, 0 when the shopper leaves signed in */
+int userDashboard(Session *session) {
+    User *user = session->user;
+    const char *username = user->username;
     
     int choice;
     do {
@@ -1205,7 +5628,9 @@ void userDashboard(const char *username) {
         printf("6. View Order History\n");
         printf("7. Track Order Status\n");
         printf("8. View Promo Codes\n");
-        printf("9. Logout\n");
+        printf("9. Search Menu\n");
+        printf("10. Logout\n");
+        printf("11. Back to Main Menu (stay signed in)\n");
         printLine();
         printf("Choice: ");
         scanf("%d", &choice);
@@ -1219,7 +5644,7 @@ void userDashboard(const char *username) {
             }
             case 2: {
                 clearScreen();
-                displayCart();
+                displayCart(session->cart);
                 pressEnter();
                 break;
             }
@@ -1231,37 +5656,45 @@ void userDashboard(const char *username) {
                 scanf("%d", &itemId);
                 printf("Enter quantity: ");
                 scanf("%d", &quantity);
-                addToCart(itemId, quantity);
+                addToCart(session->cart, itemId, quantity);
+                recordCommand("add %d %d", itemId, quantity);
                 pressEnter();
                 break;
             }
             case 4: {
                 clearScreen();
-                displayCart();
-                if (cartHead != NULL) {
+                displayCart(session->cart);
+                if (session->cart->head != NULL) {
                     printf("\nEnter item ID to remove: ");
                     int itemId;
                     scanf("%d", &itemId);
-                    removeFromCart(itemId);
+                    removeFromCart(session->cart, itemId);
+                    recordCommand("remove %d", itemId);
                 }
                 pressEnter();
                 break;
             }
             case 5: {
                 clearScreen();
-                checkout(username, user->address, user->phone);
+                checkout(session);
                 pressEnter();
                 break;
             }
             case 6: {
                 clearScreen();
                 printHeader("YOUR ORDER HISTORY");
-                if (historyRoot == NULL) {
+                int accountId = findAccount(username);
+                if (accountOrderCount(accountId) == 0) {
                     printf("No order history yet.\n");
                 } else {
                     printf("Order ID\tStatus\t\t\tTotal\t\tOrder Time\n");
                     printf("────────────────────────────────────────────────────────────────\n");
-                    displayUserOrderHistory(historyRoot, username);
+                    for (int page = 0; displayUserOrderHistory(accountId, page); page++) {
+                        char more;
+                        printf("Show older orders? (y/n): ");
+                        scanf(" %c", &more);
+                        if (more != 'y' && more != 'Y') break;
+                    }
                 }
                 pressEnter();
                 break;
@@ -1272,6 +5705,7 @@ void userDashboard(const char *username) {
                 printf("Enter Order ID to track: ");
                 int orderId;
                 scanf("%d", &orderId);
+                recordCommand("track %d", orderId);
                 displayOrderStatus(orderId, username, 0);
                 pressEnter();
                 break;
@@ -1282,16 +5716,42 @@ void userDashboard(const char *username) {
                 pressEnter();
                 break;
             }
-            case 9: {
+            case 9: {
+                clearScreen();
+                printHeader("SEARCH MENU");
+                printf("1. By name prefix\n");
+                printf("2. By name containing\n");
+                printf("3. By category\n");
+                printf("Choice: ");
+                int mode;
+                scanf("%d", &mode);
+                if (mode < 1 || mode > 3) {
+                    printf("Invalid choice!\n");
+                } else {
+                    char query[80];
+                    printf("Search for: ");
+                    scanf(" %79[^\n]", query);
+                    printf("\n");
+                    displayMenuSearch(mode, query);
+                }
+                pressEnter();
+                break;
+            }
+            case 10: {
+                recordCommand("logout");
                 printf("Logging out...\n");
                 break;
             }
+            case 11: {
+                break;
+            }
             default: {
                 printf("Invalid choice!\n");
                 pressEnter();
             }
         }
-    } while (choice != 9);
+    } while (choice != 10 && choice != 11);
+    return choice == 10;
 }
 
 void adminDashboard() {
@@ -1308,9 +5768,13 @@ void adminDashboard() {
         printf("6. View All Users\n");
         printf("7. View Order History\n");
         printf("8. Track Specific Order\n");
-        printf("9. Add Promo Code\n");
+        printf("9. Promo Codes\n");
         printf("10. Save All Data\n");
-        printf("11. Logout\n");
+        printf("11. Memory Statistics\n");
+        printf("12. Order Analytics\n");
+        printf("13. Sales Analytics\n");
+        printf("14. Kitchen Pipeline\n");
+        printf("15. Logout\n");
         printLine();
         printf("Choice: ");
         scanf("%d", &choice);
@@ -1337,6 +5801,7 @@ void adminDashboard() {
                     printf("Stock: ");
                     scanf("%d", &stock);
                     addToMenu(name, category, price, stock);
+                    recordCommand("menu-add \"%s\" \"%s\" %.2f %d", name, category, price, stock);
                 } else if (subChoice == 2) {
                     displayAllMenu();
                 }
@@ -1351,11 +5816,12 @@ void adminDashboard() {
             }
             case 3: {
                 clearScreen();
-                Order processed = popOrder();
-                if (processed.orderId != 0) {
-                    printf("Processing Order #%d...\n", processed.orderId);
-                    updateOrderStatus(&processed, 1); /* Confirmed */
-                    printf("✓ Order #%d confirmed and ready for preparation!\n", processed.orderId);
+                recordCommand("process");
+                Order *processed = popOrder();
+                if (processed != NULL) {
+                    printf("Processing Order #%d...\n", processed->orderId);
+                    updateOrderStatus(processed, 1); /* Confirmed */
+                    printf("✓ Order #%d confirmed and ready for preparation!\n", processed->orderId);
                 }
                 pressEnter();
                 break;
@@ -1382,155 +5848,1435 @@ void adminDashboard() {
                     int newStatus;
                     scanf("%d", &newStatus);
                     
-                    updateOrderStatus(order, newStatus);
-                    printf("✓ Order #%d status updated to: %s\n", orderId, getStatusText(newStatus));
+                    /* Same range the status script command accepts, so recordings replay alike */
+                    if (newStatus < 0 || newStatus > 5) {
+                        printf("✗ Invalid status!\n");
+                    } else {
+                        updateOrderStatus(order, newStatus);
+                        recordCommand("status %d %d", orderId, newStatus);
+                        printf("✓ Order #%d status updated to: %s\n", orderId, getStatusText(newStatus));
+                    }
+                }
+                pressEnter();
+                break;
+            }
+            case 5: {
+                clearScreen();
+                displayDeliveryQueue();
+                if (deliveryQueueSize() > 0) {
+                    printf("\n1. Dispatch Batch to Driver\n");
+                    printf("2. Back\n");
+                    printf("Choice: ");
+                    int subChoice;
+                    scanf("%d", &subChoice);
+                    
+                    if (subChoice == 1) {
+                        int maxOrders;
+                        printf("Orders per driver (1-%d): ", DISPATCH_BATCH_MAX);
+                        scanf("%d", &maxOrders);
+                        OrderHandle batch[DISPATCH_BATCH_MAX];
+                        int count = dispatchBatch(maxOrders, DISPATCH_MAX_WAIT, batch);
+                        recordCommand("dispatch-batch %d", maxOrders);
+                        if (count > 0) {
+                            clearScreen();
+                            displayDispatchBatch(batch, count);
+                        }
+                    }
+                }
+                pressEnter();
+                break;
+            }
+            case 6: {
+                clearScreen();
+                printHeader("ALL REGISTERED USERS");
+                printf("Username\tAddress\t\t\t\tPhone\t\tLoyalty Points\n");
+                printf("─────────────────────────────────────────────────────────────────────────────\n");
+                if (userRoot == NULL) {
+                    printf("No users registered.\n");
+                } else {
+                    displayUsersInorder(userRoot);
+                }
+                pressEnter();
+                break;
+            }
+            case 7: {
+                clearScreen();
+                printHeader("COMPLETE ORDER HISTORY");
+                if (history.count == 0) {
+                    printf("No order history.\n");
+                } else {
+                    printf("Order ID\tCustomer\t\tStatus\t\t\tTotal\t\tOrder Time\n");
+                    printf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
+                    displayOrderHistory();
+                }
+                pressEnter();
+                break;
+            }
+            case 8: {
+                clearScreen();
+                printf("Enter Order ID to track: ");
+                int orderId;
+                scanf("%d", &orderId);
+                recordCommand("track %d", orderId);
+                displayOrderStatus(orderId, "admin", 1);
+                pressEnter();
+                break;
+            }
+            case 9: {
+                clearScreen();
+                printHeader("PROMO CODES");
+                printf("1. Add a Promo Code\n");
+                printf("2. Bulk Import from CSV File\n");
+                printf("Choice: ");
+                int subChoice;
+                scanf("%d", &subChoice);
+                
+                if (subChoice == 1) {
+                    char code[20];
+                    float discount;
+                    int validDays, maxUses, maxUsesPerCustomer;
+                    printf("Enter promo code: ");
+                    scanf("%19s", code);
+                    printf("Enter discount percentage: ");
+                    scanf("%f", &discount);
+                    printf("Valid for how many days (0 = no expiry): ");
+                    scanf("%d", &validDays);
+                    printf("Maximum total uses (0 = unlimited): ");
+                    scanf("%d", &maxUses);
+                    printf("Maximum uses per customer (0 = unlimited): ");
+                    scanf("%d", &maxUsesPerCustomer);
+                    addPromoCode(code, discount, validDays, maxUses, maxUsesPerCustomer);
+                    recordCommand("promo-add %s %.2f %d %d %d", code, discount,
+                                  validDays, maxUses, maxUsesPerCustomer);
+                } else if (subChoice == 2) {
+                    char path[256];
+                    printf("CSV file (CODE,PERCENT[,FROM,UNTIL,MAX_USES,PER_CUSTOMER]): ");
+                    scanf(" %255[^\n]", path);
+                    FILE *file = fopen(path, "r");
+                    if (file == NULL) {
+                        printf("✗ Cannot open %s\n", path);
+                    } else {
+                        double start = benchNow();
+                        int imported = importPromoCodes(file);
+                        fclose(file);
+                        printf("✓ Imported %d promo codes in %.1f ms\n", imported, (benchNow() - start) * 1000);
+                        recordCommand("promo-import \"%s\"", path);
+                    }
+                }
+                pressEnter();
+                break;
+            }
+            case 10: {
+                saveData();
+                recordCommand("save");
+                pressEnter();
+                break;
+            }
+            case 11: {
+                clearScreen();
+                printHeader("MEMORY STATISTICS");
+                displayMemoryStats(stdout);
+                pressEnter();
+                break;
+            }
+            case 12: {
+                clearScreen();
+                printHeader("ORDER ANALYTICS");
+                printf("1. Orders Between Two IDs\n");
+                printf("2. Revenue in Last N Minutes\n");
+                printf("3. K-th Order\n");
+                printf("4. Browse Orders After an ID\n");
+                printf("Choice: ");
+                int subChoice;
+                scanf("%d", &subChoice);
+                
+                if (subChoice == 1) {
+                    int firstId, lastId;
+                    printf("From order ID: ");
+                    scanf("%d", &firstId);
+                    printf("To order ID: ");
+                    scanf("%d", &lastId);
+                    recordCommand("history-range %d %d", firstId, lastId);
+                    displayHistoryStats("\nOrders in range:", historyRangeById(firstId, lastId));
+                } else if (subChoice == 2) {
+                    int minutes;
+                    printf("Minutes: ");
+                    scanf("%d", &minutes);
+                    time_t now = time(NULL);
+                    recordCommand("history-window %lld %lld", (long long)(now - (time_t)minutes * 60), (long long)(now + 1));
+                    displayHistoryStats("\nOrders in window:", historyRangeByTime(now - (time_t)minutes * 60, now + 1));
+                } else if (subChoice == 3) {
+                    int k;
+                    printf("K (1 = oldest): ");
+                    scanf("%d", &k);
+                    recordCommand("history-kth %d", k);
+                    OrderHandle handle = k >= 1 ? historySelect(k - 1) : -1;
+                    if (handle == -1) {
+                        printf("No such order.\n");
+                    } else {
+                        displayOrderDetails(orderAt(handle));
+                    }
+                } else if (subChoice == 4) {
+                    int cursor;
+                    printf("Show orders after ID (0 = from the start): ");
+                    scanf("%d", &cursor);
+                    recordCommand("history-page %d %d", cursor, ORDER_HISTORY_PAGE);
+                    int orderIds[ORDER_HISTORY_PAGE];
+                    int found = historyPage(cursor, ORDER_HISTORY_PAGE, orderIds);
+                    printf("\nOrder ID\tCustomer\t\tStatus\t\t\tTotal\n");
+                    for (int i = 0; i < found; i++) {
+                        Order *order = searchOrderById(orderIds[i]);
+                        printf("#%d\t\t%-15s\t%-20s\t$%.2f\n", order->orderId, orderUsername(order),
+                               getStatusText(order->status), order->total);
+                    }
+                    if (found == ORDER_HISTORY_PAGE) {
+                        printf("Next page: after #%d\n", orderIds[found - 1]);
+                    }
                 }
                 pressEnter();
                 break;
             }
-            case 5: {
-                clearScreen();
-                displayDeliveryQueue();
-                pressEnter();
-                break;
+            case 13: {
+                clearScreen();
+                printHeader("SALES ANALYTICS");
+                displaySalesAnalytics();
+                pressEnter();
+                break;
+            }
+            case 14: {
+                clearScreen();
+                printHeader("KITCHEN PIPELINE");
+                displayPipelineStats();
+                printf("\n1. Start Pipeline\n");
+                printf("2. Stop Pipeline (drain)\n");
+                printf("3. Back\n");
+                printf("Choice: ");
+                int subChoice;
+                scanf("%d", &subChoice);
+                
+                if (subChoice == 1) {
+                    int workers[PIPELINE_STAGES], handoff[PIPELINE_STAGES];
+                    printf("Workers for Confirm Prepare Dispatch Deliver (e.g. 1 4 1 2): ");
+                    scanf("%d %d %d %d", &workers[0], &workers[1], &workers[2], &workers[3]);
+                    printf("Seconds in each stage before moving on, -1 = by hand (e.g. 0 -1 -1 -1): ");
+                    scanf("%d %d %d %d", &handoff[0], &handoff[1], &handoff[2], &handoff[3]);
+                    int started = startKitchenPipeline(workers, handoff, NULL);
+                    if (started == 0) {
+                        printf("✗ Pipeline is already running\n");
+                    }
+                    if (started == 1) {
+                        recordCommand("pipeline start %d %d %d %d %d %d %d %d", workers[0], workers[1], workers[2], workers[3],
+                                      handoff[0], handoff[1], handoff[2], handoff[3]);
+                    }
+                } else if (subChoice == 2) {
+                    stopKitchenPipeline();
+                    recordCommand("pipeline stop");
+                    displayPipelineStats();
+                }
+                pressEnter();
+                break;
+            }
+            case 15: {
+                printf("Admin logging out...\n");
+                break;
+            }
+            default: {
+                printf("Invalid choice!\n");
+                pressEnter();
+            }
+        }
+    } while (choice != 15);
+}
+
+/* The shopper signed in at this terminal; kept between dashboard visits until logout */
+static Session *terminalSession = NULL;
+
+void userLogin() {
+    char username[MAX_NAME];
+    char password[MAX_PASS];
+    
+    printHeader("USER LOGIN");
+    
+    if (terminalSession != NULL) {
+        Session *resumed = resumeSession(terminalSession->token, terminalSession);
+        if (resumed != NULL) {
+            char answer;
+            printf("Continue as %s? (y/n): ", resumed->user->username);
+            scanf(" %c", &answer);
+            if (answer == 'y' || answer == 'Y') {
+                if (userDashboard(resumed)) {
+                    closeSession(resumed);
+                    terminalSession = NULL;
+                }
+                return;
+            }
+            recordCommand("logout");
+        } else {
+            printf("Session expired, please log in again.\n");
+        }
+        closeSession(terminalSession);
+        terminalSession = NULL;
+    }
+    
+    printf("Username: ");
+    scanf("%49s", username);
+    
+    printf("Password: ");
+    scanf("%49s", password);
+    
+    User *user = searchUser(userRoot, username);
+    if (user == NULL || !verifyPassword(user, password)) {
+        printf("✗ Invalid username or password!\n");
+        return;
+    }
+    
+    printf("\n✓ Login successful!\n");
+    recordCommand("login %s ***", username);     /* Passwords never reach the record file */
+    
+    Session *session = openSession(user);
+    issueSessionToken(user, session->token);
+    if (userDashboard(session)) {
+        closeSession(session);
+    } else {
+        terminalSession = session;
+    }
+}
+
+void userSignup() {
+    char username[MAX_NAME];
+    char password[MAX_PASS];
+    char address[MAX_ADDR];
+    char phone[MAX_PHONE];
+    
+    printHeader("USER SIGNUP");
+    
+    printf("Choose username: ");
+    scanf("%s", username);
+    
+    /* Check if username exists */
+    if (searchUser(userRoot, username) != NULL) {
+        printf("✗ Username already exists!\n");
+        return;
+    }
+    
+    printf("Choose password: ");
+    scanf("%s", password);
+    printf("Enter address: ");
+    scanf(" %[^\n]", address);
+    printf("Enter phone number: ");
+    scanf("%s", phone);
+    
+    char credential[MAX_PASSWORD_HASH];
+    hashPassword(password, passwordCost, credential);
+    User *newUser = createUser(username, credential, address, phone);
+    userRoot = insertUser(userRoot, newUser);
+    recordCommand("signup %s *** %s \"%s\"", username, phone, address);
+    
+    printf("\n✓ Account created successfully! You can now login.\n");
+}
+
+void adminLogin() {
+    char username[MAX_NAME];
+    char password[MAX_PASS];
+    
+    printHeader("ADMIN LOGIN");
+    
+    printf("Username: ");
+    scanf("%s", username);
+    printf("Password: ");
+    scanf("%s", password);
+    
+    User *admin = searchUser(userRoot, username);
+    if (isAdminUser(admin) && verifyPassword(admin, password)) {
+        printf("\n✓ Admin login successful!\n");
+        adminDashboard();
+    } else {
+        printf("✗ Invalid admin credentials!\n");
+    }
+}
+
+/* =============================== MICROBENCHMARKS =============================== */
+double benchNow() {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+long peakRssKb() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+unsigned int benchRandom() {
+    static unsigned int state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void benchReport(FILE *json, const char *op, int n, long long ops, double seconds, long long allocations) {
+    double nsPerOp = ops > 0 ? seconds * 1e9 / ops : 0;
+    double allocsPerOp = ops > 0 ? (double)allocations / ops : 0;
+    long rss = peakRssKb();
+    
+    printf("%-26s %10d %10lld %12.1f %10.2f %12ld\n", op, n, ops, nsPerOp, allocsPerOp, rss);
+    if (json != NULL) {
+        fprintf(json, "{\"op\":\"%s\",\"n\":%d,\"ops\":%lld,\"ns_per_op\":%.1f,"
+                      "\"allocs_per_op\":%.3f,\"peak_rss_kb\":%ld}\n",
+                op, n, ops, nsPerOp, allocsPerOp, rss);
+        fflush(json);
+    }
+}
+
+/* Bytes held per stored order: its store slot, item lines and its share of
+ * the interned customer records */
+void reportOrderFootprint(int n, FILE *json) {
+    long long orders = orderStore.count;
+    if (orders == 0) return;
+    
+    double lineBytes = (double)lineArena.used * sizeof(OrderLine) / orders;  /* Skipped block tails included */
+    double customerBytes = ((double)customerTable.count * sizeof(Customer) +
+                            (double)customerTable.accountCount * sizeof(Account)) / orders;
+    double total = sizeof(Order) + lineBytes + customerBytes;
+    
+    printf("%-26s %10d %10lld   header %zu B + lines %.1f B + customer %.1f B = %.1f B/order\n",
+           "orderFootprint", n, orders, sizeof(Order), lineBytes, customerBytes, total);
+    if (json != NULL) {
+        fprintf(json, "{\"op\":\"orderFootprint\",\"n\":%d,\"orders\":%lld,\"header_bytes\":%zu,"
+                      "\"line_bytes\":%.1f,\"customer_bytes\":%.1f,\"bytes_per_order\":%.1f}\n",
+                n, orders, sizeof(Order), lineBytes, customerBytes, total);
+        fflush(json);
+    }
+}
+
+/* Times a block of work; lookup loops stop once BENCH_TIME_BUDGET is spent */
+#define BENCH_BEGIN() \
+    do { long long benchAllocs = allocationCount; double benchStart = benchNow(); long long benchOps = 0
+#define BENCH_OVER_BUDGET() \
+    ((benchOps & 255) == 0 && benchNow() - benchStart > BENCH_TIME_BUDGET)
+#define BENCH_END(op, n) \
+    benchReport(json, op, n, benchOps, benchNow() - benchStart, allocationCount - benchAllocs); } while (0)
+
+/* Lookup results are folded in here so the compiler cannot drop the calls */
+volatile size_t benchSink = 0;
+
+void benchmarkSize(int n, FILE *json) {
+    char name[MAX_NAME], code[20];
+    resetSystemState();
+    
+    /* Menu catalog, item ids 1..n */
+    menuCatalog.nextId = 1;
+    BENCH_BEGIN();
+    for (int i = 0; i < n; i++, benchOps++) {
+        snprintf(name, sizeof(name), "Item %d", i);
+        snprintf(code, sizeof(code), "Category %d", i % (n / 100 + 1));
+        createFoodItem(menuCatalog.nextId++, name, code, 1.0f + i % 50, INT_MAX / 2);
+    }
+    BENCH_END("addToMenu", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)findMenuItem(1 + benchRandom() % n);
+    }
+    BENCH_END("findMenuItem", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int slots[MENU_SEARCH_MAX];
+        snprintf(name, sizeof(name), "Item %u", benchRandom() % n);
+        benchSink += (size_t)searchMenuByPrefix(name, slots, MENU_SEARCH_MAX);
+    }
+    BENCH_END("searchMenuByPrefix", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int slots[MENU_SEARCH_MAX];
+        snprintf(name, sizeof(name), "m %u", benchRandom() % n);
+        benchSink += (size_t)searchMenuBySubstring(name + 2, slots, MENU_SEARCH_MAX);
+    }
+    BENCH_END("searchMenuBySubstring", n);
+    
+    /* Shopping cart with n lines */
+    userRoot = insertUser(userRoot, createUser("benchuser", "secret", "1 Bench Street", "5550100"));
+    Session *session = openSession(searchUser(userRoot, "benchuser"));
+    Cart *cart = session->cart;
+    for (int i = 0; i < n; i++) {
+        addToCart(cart, 1 + i, 1);
+    }
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)calculateCartTotal(cart);
+    }
+    BENCH_END("calculateCartTotal", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int itemId = 1 + benchRandom() % n;
+        removeFromCart(cart, itemId);
+        addToCart(cart, itemId, 1);
+    }
+    BENCH_END("removeFromCart+addToCart", n);
+    clearCart(cart);
+    
+    /* Promo codes: capped globally, so every redemption takes the CAS path */
+    BENCH_BEGIN();
+    reservePromoCapacity(n);
+    for (int i = 0; i < n; i++, benchOps++) {
+        snprintf(code, sizeof(code), "CODE%d", i);
+        insertPromoCode(code, 10, 0, 0, INT_MAX, 0);
+    }
+    BENCH_END("insertPromoCode", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        snprintf(code, sizeof(code), "CODE%u", benchRandom() % n);
+        benchSink += (size_t)redeemPromoCode(code, "benchuser", 100.0f);
+    }
+    BENCH_END("redeemPromoCode", n);
+    
+    /* Users, inserted in random order */
+    BENCH_BEGIN();
+    for (int i = 0; i < n; i++, benchOps++) {
+        snprintf(name, sizeof(name), "user%08x", (unsigned int)i * 2654435761u);
+        userRoot = insertUser(userRoot, createUser(name, "secret", "1 Bench Street", "5550100"));
+    }
+    BENCH_END("insertUser", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        snprintf(name, sizeof(name), "user%08x", (benchRandom() % n) * 2654435761u);
+        benchSink += (size_t)searchUser(userRoot, name);
+    }
+    BENCH_END("searchUser", n);
+    
+    /* Orders: the store is filled untimed, then each structure is timed */
+    int benchCustomer = internCustomer("benchuser", "1 Bench Street", "5550100");
+    for (int i = 0; i < n; i++) {
+        createOrder(benchCustomer, 1 + i % PRIORITY_LEVELS);
+    }
+    
+    BENCH_BEGIN();
+    for (OrderHandle handle = 0; handle < n; handle++, benchOps++) {
+        deliveryAppend(handle, 0);
+    }
+    BENCH_END("enqueueDelivery", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int ahead;
+        benchSink += (size_t)estimateDelivery(orderAt(benchRandom() % n), &ahead) + ahead;
+    }
+    BENCH_END("estimateDelivery", n);
+    
+    BENCH_BEGIN();
+    while (deliveryPopFront(0) != -1) {
+        benchOps++;
+    }
+    BENCH_END("dequeueDelivery", n);
+    
+    BENCH_BEGIN();
+    for (OrderHandle handle = 0; handle < n; handle++, benchOps++) {
+        appendOrderHistory(handle);
+    }
+    BENCH_END("appendOrderHistory", n);
+    
+    BENCH_BEGIN();
+    rebuildOrderHistory();
+    benchOps = n;
+    BENCH_END("rebuildOrderHistory", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)searchOrderHistoryById(1000 + benchRandom() % n);
+    }
+    BENCH_END("searchOrderHistoryById", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int first = 1000 + benchRandom() % n;
+        benchSink += historyRangeById(first, first + n / 10).count;
+    }
+    BENCH_END("historyRangeById", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)historySelect(benchRandom() % n);
+    }
+    BENCH_END("historySelect", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)searchOrderById(1000 + benchRandom() % n);
+    }
+    BENCH_END("searchOrderById", n);
+    
+    /* Full checkout: three cart lines, then order placement end to end */
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        for (int line = 0; line < 3; line++) {
+            addToCart(cart, 1 + benchRandom() % n, 1);
+        }
+        placeOrder(session, "skip", 1 + i % PRIORITY_LEVELS);
+    }
+    BENCH_END("checkout", n);
+    reportOrderFootprint(n, json);
+    
+    /* Analytics over every stored order, not just the timed checkouts */
+    BENCH_BEGIN();
+    rebuildSalesAnalytics();
+    benchOps = orderStore.count;
+    BENCH_END("rebuildSalesAnalytics", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < 16 && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        benchSink += (size_t)summarizeSales(0, LLONG_MAX).units;
+    }
+    BENCH_END("summarizeSales(all)", n);
+    
+    BENCH_BEGIN();
+    for (int i = 0; i < 16 && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int top[ANALYTICS_TOP_N];
+        benchSink += topSellingItems(ANALYTICS_TOP_N, top, NULL, NULL);
+    }
+    BENCH_END("topSellingItems", n);
+    
+    /* "My Orders": newest page of one customer among all the others' orders */
+    int accountId = findAccount("benchuser");
+    int page[ORDER_HISTORY_PAGE];
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        int skip = (benchRandom() % 4) * ORDER_HISTORY_PAGE;
+        benchSink += recentAccountOrders(accountId, skip, ORDER_HISTORY_PAGE, page);
+    }
+    BENCH_END("recentAccountOrders", n);
+    
+    /* Short-lived carts: one per session, as at login/logout */
+    BENCH_BEGIN();
+    for (int i = 0; i < n && !BENCH_OVER_BUDGET(); i++, benchOps++) {
+        Cart *shortCart = createCart();
+        addToCart(shortCart, 1 + benchRandom() % n, 1);
+        destroyCart(shortCart);
+    }
+    BENCH_END("createCart+destroyCart", n);
+    closeSession(session);
+}
+
+void runBenchmarks(int maxN, FILE *json) {
+    quietMode = 1;
+    printf("%-26s %10s %10s %12s %10s %12s\n", "operation", "n", "ops", "ns/op", "allocs/op", "peak RSS KB");
+    for (long long n = BENCH_MIN_N; n <= maxN; n *= 10) {
+        benchmarkSize((int)n, json);
+    }
+    resetSystemState();
+}
+
+void* checkoutWorker(void *arg) {
+    CheckoutWorker *worker = (CheckoutWorker*)arg;
+    unsigned int state = worker->seed;
+    
+    for (int i = 0; i < worker->orders; i++) {
+        for (int line = 0; line < worker->lines; line++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            addToCart(worker->session->cart, 1 + state % CHECKOUT_BENCH_ITEMS, 1);
+        }
+        
+        /* addToCart may refuse lines already sold out, so count what is really in it */
+        int units = cartItemCount(worker->session->cart);
+        
+        if (placeOrder(worker->session, "skip", 1 + i % PRIORITY_LEVELS) != NULL) {
+            worker->placed++;
+            worker->unitsOrdered += units;
+        } else {
+            worker->rejected++;
+            clearCart(worker->session->cart);
+        }
+    }
+    return NULL;
+}
+
+/* Runs the same checkout volume on 1, 2, 4 ... maxThreads workers, then a
+ * scarce-stock run that must sell exactly the stock that existed */
+void runCheckoutThroughput(int maxThreads, FILE *json) {
+    quietMode = 1;
+    printf("%-26s %10s %10s %12s %10s %12s\n", "operation", "threads", "orders", "orders/s", "rejected", "peak RSS KB");
+    
+    for (int pass = 0; pass < 2; pass++) {
+        int scarce = (pass == 1);
+        for (int threads = scarce ? maxThreads : 1; threads <= maxThreads; threads *= 2) {
+            resetSystemState();
+            int initialStock = scarce ? 50 : INT_MAX / 2;
+            menuCatalog.nextId = 1;
+            for (int i = 0; i < CHECKOUT_BENCH_ITEMS; i++) {
+                char name[MAX_NAME];
+                snprintf(name, sizeof(name), "Item %d", i);
+                createFoodItem(menuCatalog.nextId++, name, "Bench", 5.0f, initialStock);
+            }
+            
+            CheckoutWorker *workers = (CheckoutWorker*)xcalloc(threads, sizeof(CheckoutWorker));
+            pthread_t *ids = (pthread_t*)xmalloc(sizeof(pthread_t) * threads);
+            for (int t = 0; t < threads; t++) {
+                char name[MAX_NAME];
+                snprintf(name, sizeof(name), "worker%d", t);
+                userRoot = insertUser(userRoot, createUser(name, "secret", "1 Bench Street", "5550100"));
+                workers[t].session = openSession(searchUser(userRoot, name));
+                workers[t].orders = CHECKOUT_BENCH_ORDERS / threads;
+                workers[t].lines = 3;
+                workers[t].seed = 2463534242u + t * 7919u;
             }
-            case 6: {
-                clearScreen();
-                printHeader("ALL REGISTERED USERS");
-                printf("Username\tAddress\t\t\t\tPhone\t\tLoyalty Points\n");
-                printf("─────────────────────────────────────────────────────────────────────────────\n");
-                if (userRoot == NULL) {
-                    printf("No users registered.\n");
-                } else {
-                    displayUsersInorder(userRoot);
-                }
-                pressEnter();
-                break;
+            
+            double start = benchNow();
+            for (int t = 0; t < threads; t++) {
+                pthread_create(&ids[t], NULL, checkoutWorker, &workers[t]);
             }
-            case 7: {
-                clearScreen();
-                printHeader("COMPLETE ORDER HISTORY");
-                if (historyRoot == NULL) {
-                    printf("No order history.\n");
-                } else {
-                    printf("Order ID\tCustomer\t\tStatus\t\t\tTotal\t\tOrder Time\n");
-                    printf("─────────────────────────────────────────────────────────────────────────────────────────────\n");
-                    displayOrderHistoryInorder(historyRoot);
-                }
-                pressEnter();
-                break;
+            for (int t = 0; t < threads; t++) {
+                pthread_join(ids[t], NULL);
             }
-            case 8: {
-                clearScreen();
-                printf("Enter Order ID to track: ");
-                int orderId;
-                scanf("%d", &orderId);
-                displayOrderStatus(orderId, "admin", 1);
-                pressEnter();
-                break;
+            double seconds = benchNow() - start;
+            
+            long long placed = 0, rejected = 0, units = 0;
+            for (int t = 0; t < threads; t++) {
+                placed += workers[t].placed;
+                rejected += workers[t].rejected;
+                units += workers[t].unitsOrdered;
+                closeSession(workers[t].session);
             }
-            case 9: {
-                clearScreen();
-                char code[20];
-                float discount;
-                printf("Enter promo code: ");
-                scanf("%s", code);
-                printf("Enter discount percentage: ");
-                scanf("%f", &discount);
-                addPromoCode(code, discount);
-                pressEnter();
-                break;
+            
+            /* Every unit sold must have come out of stock exactly once */
+            long long remaining = 0;
+            int negative = 0;
+            for (int slot = 0; slot < menuCatalog.count; slot++) {
+                int stock = menuItemAt(slot)->stock;
+                remaining += stock;
+                if (stock < 0) negative = 1;
             }
-            case 10: {
-                saveData();
-                pressEnter();
-                break;
+            long long expected = (long long)initialStock * CHECKOUT_BENCH_ITEMS - units;
+            const char *op = scarce ? "checkout-scarce-stock" : "checkout-parallel";
+            
+            printf("%-26s %10d %10lld %12.0f %10lld %12ld%s\n", op, threads, placed,
+                   seconds > 0 ? placed / seconds : 0.0, rejected, peakRssKb(),
+                   (remaining != expected || negative) ? "  OVERSOLD!" : "");
+            if (json != NULL) {
+                fprintf(json, "{\"op\":\"%s\",\"threads\":%d,\"orders\":%lld,\"orders_per_sec\":%.0f,"
+                              "\"rejected\":%lld,\"oversold\":%d,\"peak_rss_kb\":%ld}\n",
+                        op, threads, placed, seconds > 0 ? placed / seconds : 0.0, rejected,
+                        remaining != expected || negative, peakRssKb());
+                fflush(json);
             }
-            case 11: {
-                printf("Admin logging out...\n");
+            
+            free(workers);
+            free(ids);
+        }
+    }
+    resetSystemState();
+}
+
+/* Full password logins per second at each cost, then token re-authentication */
+void runLoginBenchmark(FILE *json) {
+    quietMode = 1;
+    int savedCost = passwordCost;
+    printf("%-26s %10s %10s %12s %10s %12s\n", "operation", "cost", "logins", "logins/s", "ms/login", "peak RSS KB");
+    
+    resetSystemState();
+    char credential[MAX_PASSWORD_HASH], token[SESSION_TOKEN_BYTES * 2 + 1];
+    User *user = createUser("benchuser", "", "1 Bench Street", "5550100");
+    userRoot = insertUser(userRoot, user);
+    
+    for (int cost = 8; cost <= 16; cost += 2) {
+        passwordCost = cost;
+        hashPassword("correct horse", cost, credential);
+        strcpy(user->credential, credential);
+        
+        long long logins = 0;
+        double start = benchNow(), seconds = 0;
+        do {
+            if (!verifyPassword(user, "correct horse")) {
+                printf("verifyPassword failed at cost %d\n", cost);
                 break;
             }
-            default: {
-                printf("Invalid choice!\n");
-                pressEnter();
-            }
+            logins++;
+            seconds = benchNow() - start;
+        } while (seconds < BENCH_TIME_BUDGET || logins < 3);
+        if (logins == 0) continue;
+        
+        printf("%-26s %10d %10lld %12.0f %10.2f %12ld\n", "verifyPassword", cost, logins,
+               logins / seconds, seconds * 1000 / logins, peakRssKb());
+        if (json != NULL) {
+            fprintf(json, "{\"op\":\"verifyPassword\",\"cost\":%d,\"logins\":%lld,\"logins_per_sec\":%.0f,"
+                          "\"peak_rss_kb\":%ld}\n", cost, logins, logins / seconds, peakRssKb());
+            fflush(json);
+        }
+    }
+    
+    issueSessionToken(user, token);
+    long long resumes = 0;
+    double start = benchNow(), seconds;
+    do {
+        for (int i = 0; i < 1000; i++, resumes++) {
+            benchSink += (size_t)authenticateToken(token);
         }
-    } while (choice != 11);
+        seconds = benchNow() - start;
+    } while (seconds < BENCH_TIME_BUDGET);
+    printf("%-26s %10s %10lld %12.0f %10.5f %12ld\n", "authenticateToken", "-", resumes,
+           resumes / seconds, seconds * 1000 / resumes, peakRssKb());
+    if (json != NULL) {
+        fprintf(json, "{\"op\":\"authenticateToken\",\"logins\":%lld,\"logins_per_sec\":%.0f,"
+                      "\"peak_rss_kb\":%ld}\n", resumes, resumes / seconds, peakRssKb());
+        fflush(json);
+    }
+    
+    passwordCost = savedCost;
+    resetSystemState();
 }
 
-void userLogin() {
-    char username[MAX_NAME];
-    char password[MAX_PASS];
-    
-    printHeader("USER LOGIN");
+/* Simulated shift: orders arrive across DISPATCH_SIM_ZONES streets and a
+ * fixed driver fleet takes trips of up to K orders. A trip costs a fixed
+ * drive out and back plus a few minutes per stop, so deliveries per hour
+ * on the road show what batching buys and the waits show what it costs */
+#define DISPATCH_SIM_ZONES 24
+#define DISPATCH_SIM_DRIVERS 40
+#define DISPATCH_SIM_MINUTES (8 * 60)
+#define DISPATCH_SIM_TRIP_MINUTES 30
+#define DISPATCH_SIM_STOP_MINUTES 5
+
+void runDispatchSimulation(FILE *json) {
+    static const char *streets[DISPATCH_SIM_ZONES] = {
+        "Alder", "Birch", "Cedar", "Dogwood", "Elm", "Fir", "Ginkgo", "Hazel",
+        "Ivy", "Juniper", "Kauri", "Larch", "Maple", "Nutmeg", "Oak", "Pine",
+        "Quince", "Rowan", "Spruce", "Teak", "Upas", "Vine", "Willow", "Yew"
+    };
+    static const int batchSizes[] = { 1, 2, 3, 5, 8 };
     
-    printf("Username: ");
-    scanf("%s", username);
-    printf("Password: ");
-    scanf("%s", password);
+    quietMode = 1;
+    printf("%-26s %10s %10s %12s %10s %12s %10s\n", "operation", "batch", "delivered", "orders/trip",
+           "per drv-h", "avg wait min", "max wait");
     
-    User *user = searchUser(userRoot, username);
-    if (user == NULL || strcmp(user->password, password) != 0) {
-        printf("✗ Invalid username or password!\n");
-        return;
+    for (size_t run = 0; run < sizeof(batchSizes) / sizeof(batchSizes[0]); run++) {
+        int k = batchSizes[run];
+        resetSystemState();
+        
+        /* Eight households per street, so every zone interns several addresses */
+        int customers[DISPATCH_SIM_ZONES * 8];
+        for (int i = 0; i < DISPATCH_SIM_ZONES * 8; i++) {
+            char name[MAX_NAME], address[MAX_ADDR];
+            snprintf(name, sizeof(name), "sim%d", i);
+            snprintf(address, sizeof(address), "%d %s Street", 10 + i, streets[i % DISPATCH_SIM_ZONES]);
+            customers[i] = internCustomer(name, address, "5550100");
+        }
+        
+        unsigned int state = 2463534242u;
+        time_t shiftStart = 1700000000;
+        int driverFreeAt[DISPATCH_SIM_DRIVERS] = {0};
+        long long delivered = 0, trips = 0, drivingMinutes = 0;
+        double waitMinutes = 0, maxWait = 0, dispatchSeconds = 0;
+        OrderHandle batch[DISPATCH_BATCH_MAX];
+        
+        for (int minute = 0; minute < DISPATCH_SIM_MINUTES; minute++) {
+            time_t now = shiftStart + (time_t)minute * 60;
+            
+            /* 0-4 orders a minute, 2 on average */
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            for (int arrivals = state % 5; arrivals > 0; arrivals--) {
+                state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+                Order *order = createOrder(customers[state % (DISPATCH_SIM_ZONES * 8)], 1 + (state >> 8) % PRIORITY_LEVELS);
+                order->orderTime = order->statusTime = now;
+                deliveryAppend(orderStore.count - 1, 0);
+            }
+            
+            for (int d = 0; d < DISPATCH_SIM_DRIVERS; d++) {
+                if (driverFreeAt[d] > minute) continue;
+                double start = benchNow();
+                int count = deliveryTakeBatch(k, DISPATCH_MAX_WAIT, now, batch, 0);
+                dispatchSeconds += benchNow() - start;
+                if (count == 0) break;
+                
+                for (int i = 0; i < count; i++) {
+                    double waited = (double)(now - orderAt(batch[i])->orderTime) / 60;
+                    waitMinutes += waited;
+                    if (waited > maxWait) maxWait = waited;
+                }
+                int tripMinutes = DISPATCH_SIM_TRIP_MINUTES + DISPATCH_SIM_STOP_MINUTES * count;
+                delivered += count;
+                trips++;
+                drivingMinutes += tripMinutes;
+                driverFreeAt[d] = minute + tripMinutes;
+            }
+        }
+        
+        double perTrip = trips > 0 ? (double)delivered / trips : 0;
+        double perDriverHour = drivingMinutes > 0 ? delivered * 60.0 / drivingMinutes : 0;
+        double avgWait = delivered > 0 ? waitMinutes / delivered : 0;
+        printf("%-26s %10d %10lld %12.2f %10.2f %12.1f %10.0f  (%d left, %.0f ns/trip)\n",
+               "dispatchBatch", k, delivered, perTrip, perDriverHour, avgWait, maxWait,
+               deliveryQueueSize(), trips > 0 ? dispatchSeconds * 1e9 / trips : 0.0);
+        if (json != NULL) {
+            fprintf(json, "{\"op\":\"dispatchBatch\",\"batch\":%d,\"orders\":%d,\"delivered\":%lld,"
+                          "\"trips\":%lld,\"orders_per_trip\":%.2f,\"deliveries_per_driver_hour\":%.2f,"
+                          "\"avg_wait_min\":%.1f,\"max_wait_min\":%.0f,\"left_queued\":%d}\n",
+                    k, orderStore.count, delivered, trips, perTrip, perDriverHour, avgWait, maxWait,
+                    deliveryQueueSize());
+            fflush(json);
+        }
     }
+    resetSystemState();
+}
+
+/* The same order volume through pools of different shapes: a balanced
+ * single-worker line is bound by its slowest stage, while sizing the
+ * pools to the stage times moves the bottleneck and shows the stalls */
+#define PIPELINE_BENCH_ORDERS 4000
+
+void runPipelineBenchmark(FILE *json) {
+    static const int shapes[][PIPELINE_STAGES] = { { 1, 1, 1, 1 }, { 1, 4, 1, 3 }, { 2, 8, 2, 6 } };
     
-    printf("\n✓ Login successful!\n");
-    userDashboard(username);
+    quietMode = 1;
+    printf("%-26s %10s %10s %12s %10s %12s\n", "operation", "workers", "orders", "orders/s", "stalls", "avg ms");
+    
+    for (size_t run = 0; run < sizeof(shapes) / sizeof(shapes[0]); run++) {
+        const int *workers = shapes[run];
+        resetSystemState();
+        int customer = internCustomer("benchuser", "1 Bench Street", "5550100");
+        for (int i = 0; i < PIPELINE_BENCH_ORDERS; i++) {
+            createOrder(customer, 1 + i % PRIORITY_LEVELS);
+            stackPushHandle(i, 0);
+            deliveryAppend(i, 0);
+        }
+        
+        startKitchenPipeline(workers, NULL, pipelineDefaultMicros);
+        while (pipelineCompleted() < PIPELINE_BENCH_ORDERS) {
+            pauseMicros(1000);
+        }
+        stopKitchenPipeline();
+        
+        char shape[32];
+        snprintf(shape, sizeof(shape), "%d/%d/%d/%d", workers[0], workers[1], workers[2], workers[3]);
+        double seconds = kitchenPipeline.stoppedAt - kitchenPipeline.startedAt;
+        long long stalls = 0;
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+            stalls += kitchenPipeline.stages[s].stalls;
+        }
+        printf("%-26s %10s %10d %12.0f %10lld %12s\n", "pipeline", shape, PIPELINE_BENCH_ORDERS,
+               PIPELINE_BENCH_ORDERS / seconds, stalls, "-");
+        
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+            PipelineStage *stage = &kitchenPipeline.stages[s];
+            char op[32];
+            snprintf(op, sizeof(op), "  %s", stage->name);
+            double avgMs = stage->processed > 0 ? stage->latencyMicros / 1000.0 / stage->processed : 0;
+            printf("%-26s %10d %10lld %12.0f %10lld %12.2f\n", op, stage->workers,
+                   (long long)stage->processed, stage->processed / seconds, (long long)stage->stalls, avgMs);
+            if (json != NULL) {
+                fprintf(json, "{\"op\":\"pipeline\",\"shape\":\"%s\",\"stage\":\"%s\",\"workers\":%d,"
+                              "\"orders\":%lld,\"orders_per_sec\":%.0f,\"stalls\":%lld,\"avg_latency_ms\":%.2f}\n",
+                        shape, stage->name, stage->workers, (long long)stage->processed,
+                        stage->processed / seconds, (long long)stage->stalls, avgMs);
+                fflush(json);
+            }
+        }
+    }
+    resetSystemState();
 }
 
-void userSignup() {
-    char username[MAX_NAME];
-    char password[MAX_PASS];
-    char address[MAX_ADDR];
-    char phone[MAX_PHONE];
+/* =============================== HEADLESS COMMAND DRIVER =============================== */
+/* Splits a script line into arguments; "double quotes" group words */
+int splitScriptLine(char *line, char *args[], int maxArgs) {
+    int argc = 0;
+    char *p = line;
     
-    printHeader("USER SIGNUP");
+    while (*p != '\0' && argc < maxArgs) {
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') break;
+        
+        if (*p == '"') {
+            args[argc++] = ++p;
+            while (*p != '\0' && *p != '"') p++;
+        } else {
+            args[argc++] = p;
+            while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+        }
+        if (*p != '\0') *p++ = '\0';
+    }
+    return argc;
+}
+
+/* Commands that sit behind the admin dashboard interactively */
+static const char *adminScriptCommands[] = {
+    "menu-add", "promo-add", "promo-import", "process", "dispatch", "dispatch-batch", "pipeline",
+    "status", "save", "history-range", "history-window", "history-kth", "history-page",
+    "analytics", "memory", NULL
+};
+
+/* Same rule as displayOrderStatus(): shoppers only see their own orders */
+static int canViewOrder(const Session *session, const Order *order) {
+    if (session == NULL) return 0;
+    return isAdminUser(session->user) || strcmp(orderUsername(order), session->user->username) == 0;
+}
+
+static int isAdminScriptCommand(const char *cmd) {
+    for (int i = 0; adminScriptCommands[i] != NULL; i++) {
+        if (strcmp(cmd, adminScriptCommands[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Executes one command and writes a single result line; returns 1 on success */
+int runScriptCommand(char *args[], int argc, Session **session, FILE *out) {
+    const char *cmd = args[0];
     
-    printf("Choose username: ");
-    scanf("%s", username);
+    if (isAdminScriptCommand(cmd) && (*session == NULL || !isAdminUser((*session)->user))) {
+        fprintf(out, "err admin login required\n");
+        return 0;
+    }
     
-    /* Check if username exists */
-    if (searchUser(userRoot, username) != NULL) {
-        printf("✗ Username already exists!\n");
-        return;
+    if (strcmp(cmd, "login") == 0 && argc == 3) {
+        User *user = searchUser(userRoot, args[1]);
+        if (user == NULL || !verifyPassword(user, args[2])) {
+            fprintf(out, "err invalid credentials\n");
+            return 0;
+        }
+        if (*session != NULL) closeSession(*session);
+        *session = openSession(user);
+        issueSessionToken(user, (*session)->token);
+        fprintf(out, "ok %s token=%s\n", user->username, (*session)->token);
+        return 1;
+    }
+    if (strcmp(cmd, "resume") == 0 && argc == 2) {
+        /* Only the token itself re-enters; logout has already revoked it */
+        Session *resumed = resumeSession(args[1], *session);
+        if (resumed == NULL) {
+            fprintf(out, "err invalid or expired token\n");
+            return 0;
+        }
+        *session = resumed;
+        fprintf(out, "ok %s\n", resumed->user->username);
+        return 1;
+    }
+    if (strcmp(cmd, "logout") == 0) {
+        if (*session != NULL) closeSession(*session);
+        *session = NULL;
+        fprintf(out, "ok\n");
+        return 1;
+    }
+    if (strcmp(cmd, "signup") == 0 && argc == 5) {
+        if (strlen(args[1]) >= MAX_NAME || strlen(args[2]) >= MAX_PASS ||
+            strlen(args[3]) >= MAX_PHONE || strlen(args[4]) >= MAX_ADDR) {
+            fprintf(out, "err field too long\n");
+            return 0;
+        }
+        if (searchUser(userRoot, args[1]) != NULL) {
+            fprintf(out, "err username exists\n");
+            return 0;
+        }
+        char credential[MAX_PASSWORD_HASH];
+        hashPassword(args[2], passwordCost, credential);
+        userRoot = insertUser(userRoot, createUser(args[1], credential, args[4], args[3]));
+        fprintf(out, "ok %s\n", args[1]);
+        return 1;
+    }
+    if (strcmp(cmd, "menu-add") == 0 && argc == 5) {
+        if (strlen(args[1]) >= sizeof(((FoodItemText*)0)->name) || strlen(args[2]) >= MAX_CATEGORY) {
+            fprintf(out, "err field too long\n");
+            return 0;
+        }
+        addToMenu(args[1], args[2], (float)atof(args[3]), atoi(args[4]));
+        fprintf(out, "ok item=%d\n", menuCatalog.nextId - 1);
+        return 1;
+    }
+    if (strcmp(cmd, "promo-add") == 0 && (argc == 3 || argc == 6)) {
+        addPromoCode(args[1], (float)atof(args[2]), argc == 6 ? atoi(args[3]) : 0,
+                     argc == 6 ? atoi(args[4]) : 0, argc == 6 ? atoi(args[5]) : 0);
+        fprintf(out, "ok\n");
+        return 1;
+    }
+    if (strcmp(cmd, "promo-import") == 0 && argc == 2) {
+        FILE *file = fopen(args[1], "r");
+        if (file == NULL) {
+            fprintf(out, "err cannot open %s\n", args[1]);
+            return 0;
+        }
+        int imported = importPromoCodes(file);
+        fclose(file);
+        fprintf(out, "ok imported=%d codes=%d\n", imported, promoTable.count);
+        return 1;
+    }
+    if (strcmp(cmd, "process") == 0) {
+        Order *processed = popOrder();
+        if (processed == NULL) {
+            fprintf(out, "err no pending orders\n");
+            return 0;
+        }
+        updateOrderStatus(processed, 1); /* Confirmed */
+        fprintf(out, "ok order=%d\n", processed->orderId);
+        return 1;
+    }
+    if (strcmp(cmd, "dispatch") == 0) {
+        Order *order = dequeueDelivery();
+        if (order == NULL) {
+            fprintf(out, "err no deliveries\n");
+            return 0;
+        }
+        fprintf(out, "ok order=%d priority=%d\n", order->orderId, order->priority);
+        return 1;
+    }
+    if (strcmp(cmd, "pipeline") == 0 && argc >= 2) {
+        if (strcmp(args[1], "start") == 0 && (argc == 6 || argc == 10)) {
+            int workers[PIPELINE_STAGES], handoff[PIPELINE_STAGES];
+            for (int s = 0; s < PIPELINE_STAGES; s++) {
+                workers[s] = atoi(args[2 + s]);
+                handoff[s] = argc == 10 ? atoi(args[6 + s]) : pipelineDefaultHandoff[s];
+            }
+            int started = startKitchenPipeline(workers, handoff, NULL);
+            if (started != 1) {
+                fprintf(out, started == 0 ? "err pipeline already running\n" : "err could not start workers\n");
+                return 0;
+            }
+            fprintf(out, "ok\n");
+            return 1;
+        }
+        if (strcmp(args[1], "wait") == 0 && (argc == 3 || argc == 4)) {
+            /* Until this many orders are delivered, nothing is left to move, or the time runs out */
+            long long target = atoll(args[2]);
+            double deadline = benchNow() + (argc == 4 ? atof(args[3]) : PIPELINE_WAIT_SECONDS);
+            const char *reason = NULL;
+            while (pipelineCompleted() < target) {
+                if (!kitchenPipeline.running) reason = "not running";
+                else if (pipelineIdle()) reason = "idle";
+                else if (benchNow() >= deadline) reason = "timeout";
+                if (reason != NULL) break;
+                pauseMicros(PIPELINE_IDLE_MICROS);
+            }
+            if (pipelineCompleted() < target) {
+                fprintf(out, "err pipeline %s delivered=%lld\n", reason, pipelineCompleted());
+                return 0;
+            }
+            fprintf(out, "ok delivered=%lld\n", pipelineCompleted());
+            return 1;
+        }
+        if (strcmp(args[1], "stop") == 0 || strcmp(args[1], "stats") == 0) {
+            if (strcmp(args[1], "stop") == 0) {
+                stopKitchenPipeline();
+            }
+            fprintf(out, "ok");
+            for (int s = 0; s < PIPELINE_STAGES; s++) {
+                PipelineStage *stage = &kitchenPipeline.stages[s];
+                fprintf(out, " %s=%lld/%lld", pipelineStageNames[s], (long long)stage->processed,
+                        (long long)stage->stalls);
+            }
+            fprintf(out, "\n");
+            return 1;
+        }
+        fprintf(out, "err usage: pipeline start W1 W2 W3 W4 [S1 S2 S3 S4] | wait N [SECONDS] | stats | stop\n");
+        return 0;
+    }
+    if (strcmp(cmd, "eta") == 0 && argc == 2) {
+        Order *order = searchOrderById(atoi(args[1]));
+        if (order == NULL || !canViewOrder(*session, order)) {
+            fprintf(out, "err unknown order\n");
+            return 0;
+        }
+        int ahead;
+        time_t estimated = estimateDelivery(order, &ahead);
+        fprintf(out, "ok order=%d eta=%ld in=%ldmin ahead=%d\n", order->orderId, (long)estimated,
+                estimated > 0 ? (long)(estimated - time(NULL)) / 60 : 0L, ahead);
+        return 1;
+    }
+    if (strcmp(cmd, "dispatch-batch") == 0 && (argc == 2 || argc == 3)) {
+        OrderHandle batch[DISPATCH_BATCH_MAX];
+        int maxWait = argc == 3 ? atoi(args[2]) * 60 : DISPATCH_MAX_WAIT;
+        int count = dispatchBatch(atoi(args[1]), maxWait, batch);
+        if (count == 0) {
+            fprintf(out, "err no deliveries\n");
+            return 0;
+        }
+        fprintf(out, "ok count=%d orders=", count);
+        for (int i = 0; i < count; i++) {
+            fprintf(out, i == 0 ? "%d" : ",%d", orderAt(batch[i])->orderId);
+        }
+        fprintf(out, " zone=%s\n", deliveryZoneName(customerAt(orderAt(batch[0])->customerId)->zone));
+        return 1;
+    }
+    if (strcmp(cmd, "status") == 0 && argc == 3) {
+        Order *order = searchOrderById(atoi(args[1]));
+        int newStatus = atoi(args[2]);
+        if (order == NULL || newStatus < 0 || newStatus > 5) {
+            fprintf(out, "err unknown order or status\n");
+            return 0;
+        }
+        updateOrderStatus(order, newStatus);
+        fprintf(out, "ok order=%d status=%d\n", order->orderId, newStatus);
+        return 1;
+    }
+    if (strcmp(cmd, "track") == 0 && argc == 2) {
+        Order *order = searchOrderById(atoi(args[1]));
+        if (order == NULL || !canViewOrder(*session, order)) {
+            fprintf(out, "err order not found\n");
+            return 0;
+        }
+        fprintf(out, "ok order=%d status=%d total=%.2f\n", order->orderId, order->status, order->total);
+        return 1;
+    }
+    if (strcmp(cmd, "save") == 0) {
+        saveData();
+        fprintf(out, "ok\n");
+        return 1;
+    }
+    if (strcmp(cmd, "history-range") == 0 && argc == 3) {
+        HistoryStats stats = historyRangeById(atoi(args[1]), atoi(args[2]));
+        fprintf(out, "ok count=%d revenue=%.2f discounts=%.2f taxes=%.2f\n",
+                stats.count, stats.revenue, stats.discounts, stats.taxes);
+        return 1;
+    }
+    if (strcmp(cmd, "history-window") == 0 && argc == 3) {
+        HistoryStats stats = historyRangeByTime((time_t)atoll(args[1]), (time_t)atoll(args[2]));
+        fprintf(out, "ok count=%d revenue=%.2f discounts=%.2f taxes=%.2f\n",
+                stats.count, stats.revenue, stats.discounts, stats.taxes);
+        return 1;
+    }
+    if (strcmp(cmd, "history-kth") == 0 && argc == 2) {
+        int k = atoi(args[1]);
+        OrderHandle handle = k >= 1 ? historySelect(k - 1) : -1;
+        if (handle == -1) {
+            fprintf(out, "err no such order\n");
+            return 0;
+        }
+        fprintf(out, "ok order=%d\n", orderAt(handle)->orderId);
+        return 1;
+    }
+    if (strcmp(cmd, "history-page") == 0 && argc == 3) {
+        int orderIds[ORDER_HISTORY_PAGE];
+        int k = atoi(args[2]);
+        if (k < 1 || k > ORDER_HISTORY_PAGE) k = ORDER_HISTORY_PAGE;
+        int found = historyPage(atoi(args[1]), k, orderIds);
+        fprintf(out, "ok");
+        for (int i = 0; i < found; i++) {
+            fprintf(out, "%s%d", i == 0 ? " orders=" : ",", orderIds[i]);
+        }
+        fprintf(out, "\n");
+        return 1;
+    }
+    if (strcmp(cmd, "search") == 0 && argc == 3) {
+        int slots[MENU_SEARCH_MAX];
+        int found;
+        if (strcmp(args[1], "prefix") == 0) {
+            found = searchMenuByPrefix(args[2], slots, MENU_SEARCH_MAX);
+        } else if (strcmp(args[1], "contains") == 0) {
+            found = searchMenuBySubstring(args[2], slots, MENU_SEARCH_MAX);
+        } else if (strcmp(args[1], "category") == 0) {
+            found = searchMenuByCategory(args[2], slots, MENU_SEARCH_MAX);
+        } else {
+            fprintf(out, "err unknown search mode\n");
+            return 0;
+        }
+        fprintf(out, "ok count=%d", found);
+        for (int i = 0; i < found; i++) {
+            fprintf(out, "%s%d", i == 0 ? " items=" : ",", menuItemAt(slots[i])->id);
+        }
+        fprintf(out, "\n");
+        return 1;
+    }
+    if (strcmp(cmd, "analytics") == 0) {
+        SalesSummary summary = summarizeSales(0, LLONG_MAX);
+        int top[ANALYTICS_TOP_N];
+        long long topUnits[ANALYTICS_TOP_N];
+        int topCount = topSellingItems(ANALYTICS_TOP_N, top, topUnits, NULL);
+        fprintf(out, "ok orders=%lld revenue=%.2f basket=%.2f promo=%lld",
+                summary.orders, summary.revenue,
+                summary.orders > 0 ? (double)summary.units / summary.orders : 0.0, summary.promoOrders);
+        for (int i = 0; i < topCount; i++) {
+            fprintf(out, "%s%d:%lld", i == 0 ? " top=" : ",", menuItemAt(top[i])->id, topUnits[i]);
+        }
+        fprintf(out, "\n");
+        return 1;
+    }
+    if (strcmp(cmd, "memory") == 0) {
+        fprintf(out, "ok");
+        for (int i = 0; i < SLAB_POOL_COUNT; i++) {
+            fprintf(out, " %s=%lld/%lld", slabPools[i]->name, slabPools[i]->live, slabPools[i]->peak);
+        }
+        fprintf(out, "\n");
+        return 1;
     }
     
-    printf("Choose password: ");
-    scanf("%s", password);
-    printf("Enter address: ");
-    scanf(" %[^\n]", address);
-    printf("Enter phone number: ");
-    scanf("%s", phone);
+    /* Everything below acts on the logged-in shopper's cart */
+    if (*session == NULL) {
+        fprintf(out, "err not logged in or unknown command\n");
+        return 0;
+    }
     
-    User *newUser = createUser(username, password, address, phone);
-    userRoot = insertUser(userRoot, newUser);
+    if (strcmp(cmd, "add") == 0 && argc == 3) {
+        int ok = addToCart((*session)->cart, atoi(args[1]), atoi(args[2]));
+        fprintf(out, ok ? "ok cart=%.2f\n" : "err cannot add (total %.2f)\n", calculateCartTotal((*session)->cart));
+        return ok;
+    }
+    if (strcmp(cmd, "remove") == 0 && argc == 2) {
+        int ok = removeFromCart((*session)->cart, atoi(args[1]));
+        fprintf(out, ok ? "ok cart=%.2f\n" : "err not in cart (total %.2f)\n", calculateCartTotal((*session)->cart));
+        return ok;
+    }
+    if (strcmp(cmd, "clear") == 0) {
+        clearCart((*session)->cart);
+        fprintf(out, "ok\n");
+        return 1;
+    }
+    if (strcmp(cmd, "checkout") == 0 && argc == 3) {
+        Order *order = placeOrder(*session, args[1], atoi(args[2]));
+        if (order == NULL) {
+            fprintf(out, "err empty cart or out of stock\n");
+            return 0;
+        }
+        fprintf(out, "ok order=%d total=%.2f\n", order->orderId, order->total);
+        return 1;
+    }
+    if (strcmp(cmd, "orders") == 0 && argc <= 2) {
+        int orderIds[ORDER_HISTORY_PAGE];
+        int page = argc == 2 ? atoi(args[1]) : 0;
+        if (page < 0 || page > INT_MAX / ORDER_HISTORY_PAGE) {
+            fprintf(out, "err invalid page\n");
+            return 0;
+        }
+        int accountId = findAccount((*session)->user->username);
+        int found = recentAccountOrders(accountId, page * ORDER_HISTORY_PAGE, ORDER_HISTORY_PAGE, orderIds);
+        fprintf(out, "ok total=%d", accountOrderCount(accountId));
+        for (int i = 0; i < found; i++) {
+            fprintf(out, "%s%d", i == 0 ? " orders=" : ",", orderIds[i]);
+        }
+        fprintf(out, "\n");
+        return 1;
+    }
     
-    printf("\n✓ Account created successfully! You can now login.\n");
+    fprintf(out, "err unknown command\n");
+    return 0;
 }
 
-void adminLogin() {
-    char username[MAX_NAME];
-    char password[MAX_PASS];
+void runScript(FILE *in, FILE *out) {
+    char line[MAX_SCRIPT_LINE];
+    char *args[MAX_SCRIPT_ARGS];
+    Session *session = NULL;
+    int lineNumber = 0, commands = 0, failures = 0;
     
-    printHeader("ADMIN LOGIN");
+    clock_t start = clock();
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        
+        int argc = splitScriptLine(line, args, MAX_SCRIPT_ARGS);
+        if (argc == 0) continue;
+        
+        fprintf(out, "%d %s ", lineNumber, args[0]);
+        commands++;
+        if (!runScriptCommand(args, argc, &session, out)) {
+            failures++;
+        }
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
     
-    printf("Username: ");
-    scanf("%s", username);
-    printf("Password: ");
-    scanf("%s", password);
+    fprintf(out, "# %d commands, %d failed, %.3f s CPU, %.0f commands/s\n",
+            commands, failures, seconds, seconds > 0 ? commands / seconds : 0.0);
     
-    User *admin = searchUser(userRoot, username);
-    if (admin != NULL && strcmp(admin->password, password) == 0) {
-        printf("\n✓ Admin login successful!\n");
-        adminDashboard();
-    } else {
-        printf("✗ Invalid admin credentials!\n");
+    if (session != NULL) {
+        closeSession(session);
     }
 }
 
 /* =============================== MAIN FUNCTION =============================== */
-int main() {
+int main(int argc, char *argv[]) {
+    const char *scriptPath = NULL;
+    const char *outPath = NULL;
+    const char *recordPath = NULL;
+    const char *benchOutPath = NULL;
+    int benchMaxN = 0;
+    int benchThreads = 0;
+    int benchLogin = 0;
+    int benchDispatch = 0;
+    int benchPipeline = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--fresh") == 0) {
+            freshState = 1;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            benchMaxN = BENCH_DEFAULT_MAX_N;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                benchMaxN = (int)atof(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--bench-threads") == 0) {
+            benchThreads = 8;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                benchThreads = atoi(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--bench-login") == 0) {
+            benchLogin = 1;
+        } else if (strcmp(argv[i], "--bench-dispatch") == 0) {
+            benchDispatch = 1;
+        } else if (strcmp(argv[i], "--bench-pipeline") == 0) {
+            benchPipeline = 1;
+        } else if (strcmp(argv[i], "--password-cost") == 0 && i + 1 < argc) {
+            passwordCost = atoi(argv[++i]);
+            if (passwordCost < PASSWORD_MIN_COST) passwordCost = PASSWORD_MIN_COST;
+            if (passwordCost > PASSWORD_MAX_COST) passwordCost = PASSWORD_MAX_COST;
+        } else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc) {
+            benchOutPath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--script FILE|-] [--out FILE] [--fresh] [--record FILE] [--password-cost N]\n"
+                            "       %s --bench [MAX_N] [--bench-threads [MAX]] [--bench-login] [--bench-dispatch]\n"
+                            "          [--bench-pipeline] [--bench-out FILE]\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+    }
+    
+    /* Benchmark mode: synthetic data only, nothing is loaded or saved */
+    if (benchMaxN > 0 || benchThreads > 0 || benchLogin || benchDispatch || benchPipeline) {
+        FILE *json = benchOutPath != NULL ? fopen(benchOutPath, "w") : NULL;
+        if (benchMaxN > 0) runBenchmarks(benchMaxN, json);
+        if (benchThreads > 0) runCheckoutThroughput(benchThreads, json);
+        if (benchLogin) runLoginBenchmark(json);
+        if (benchDispatch) runDispatchSimulation(json);
+        if (benchPipeline) runPipelineBenchmark(json);
+        if (json != NULL) fclose(json);
+        return 0;
+    }
+    
+    /* Headless mode: replay a command stream against the core functions */
+    if (scriptPath != NULL) {
+        FILE *in = strcmp(scriptPath, "-") == 0 ? stdin : fopen(scriptPath, "r");
+        FILE *out = outPath != NULL ? fopen(outPath, "w") : stdout;
+        if (in == NULL || out == NULL) {
+            fprintf(stderr, "Cannot open script or output file\n");
+            return 1;
+        }
+        
+        quietMode = 1;
+        initializeSystem();
+        runScript(in, out);
+        stopKitchenPipeline();
+        closeOrderJournal();
+        
+        if (in != stdin) fclose(in);
+        if (out != stdout) fclose(out);
+        return 0;
+    }
+    
+    if (recordPath != NULL) {
+        recordFile = fopen(recordPath, "a");
+    }
+    
     clearScreen();
     printf("╔════════════════════════════════════════════════════════════╗\n");
     printf("║          ONLINE FOOD DELIVERY MANAGEMENT SYSTEM           ║\n");
@@ -1563,7 +7309,13 @@ int main() {
                 pressEnter();
                 break;
             case 5: 
+                if (terminalSession != NULL) {
+                    closeSession(terminalSession);
+                    terminalSession = NULL;
+                }
+                stopKitchenPipeline();
                 saveData();
+                closeOrderJournal();
                 printf("\nThank you for using Online Food Delivery System!\n");
                 break;
             default: 
@@ -1572,5 +7324,8 @@ int main() {
         
     } while (mainChoice != 5);
     
+    if (recordFile != NULL) {
+        fclose(recordFile);
+    }
     return 0;
 }